@@ -69,6 +69,42 @@ DEF_WITHTABLE(crc32c_by1octet, crc32_update_by1_octet, crc32c_octet_table)
 DEF_WITHTABLE(crc32c_by2octet, crc32_update_by2_octet, crc32c_octet_table)
 DEF_WITHTABLE(crc32c_by4octet, crc32_update_by4_octet, crc32c_octet_table)
 
+/*
+ * CRCEA_SSE42_CRC32C のテーブルは実行時に構築します。
+ *
+ * crc32c_sse42() は最初の呼び出しで crc32c_sse42_init() を呼ぶため、事前の初期化は必須ではありません。
+ * 他のスレッドが構築している間は、静的なテーブルを用いる crc32c_by4octet() で計算します。
+ */
+static uint32_t crc32c_sse42_table[(sizeof(crcea_sse42_constants) + sizeof(uint32_t[256])) / sizeof(uint32_t)];
+static int crc32c_sse42_ready;  /* 0: 未構築, 1: 構築中, 2: 構築済み */
+
+void
+crc32c_sse42_init(void)
+{
+    int expect = 0;
+
+    if (__atomic_compare_exchange_n(&crc32c_sse42_ready, &expect, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        crc32_build_table(&crc32c_design, CRCEA_SSE42_CRC32C, crc32c_sse42_table);
+        __atomic_store_n(&crc32c_sse42_ready, 2, __ATOMIC_RELEASE);
+    }
+}
+
+uint32_t
+crc32c_sse42(const void *ptr, size_t len, uint32_t crc)
+{
+    if (__atomic_load_n(&crc32c_sse42_ready, __ATOMIC_ACQUIRE) != 2) {
+        crc32c_sse42_init();
+
+        if (__atomic_load_n(&crc32c_sse42_ready, __ATOMIC_ACQUIRE) != 2) {
+            return crc32c_by4octet(ptr, len, crc);
+        }
+    }
+
+    uint32_t s = crc32_setup(&crc32c_design, crc);
+    s = crc32_update_sse42_crc32c(&crc32c_design, ptr, (const char *)ptr + len, s, crc32c_sse42_table);
+    return crc32_finish(&crc32c_design, s);
+}
+
 static const uint32_t crc32c_duo_table[16][4] =
 {
     {
@@ -10,12 +10,42 @@
 
 #include "crcea/defs.h"
 
+/*
+ * libcrcea.a と利用者の間で共有される構造体の配置の版。配置が変わるたびに増やす。
+ *
+ * 1: crcea_context は design, algorithm, table, alloc, opaque のみ。
+ * 2: crcea_context の末尾に free と adaptive が加わった。
+ */
+#define CRCEA_ABI_VERSION 2
+
+int crcea_abi_version(void);
 size_t crcea_tablesize(const crcea_context *cc);
+int crcea_select_algorithm(const crcea_design *design, int algo);
 int crcea_prepare_table(crcea_context *cc);
+void crcea_release_table(crcea_context *cc);
+void *crcea_arena_alloc(void *opaque, size_t size);
 void crcea_build_table(const crcea_design *design, int algo, void *table);
 crcea_int crcea_setup(const crcea_context *cc, crcea_int crc);
 crcea_int crcea_update(const crcea_context *cc, const void *src, const void *srcend, crcea_int state);
+crcea_int crcea_updatev(const crcea_context *cc, const crcea_iovec *iov, size_t iovcnt, crcea_int state);
+crcea_int crcea_update_bits(const crcea_context *cc, const void *src, size_t nbits, crcea_int state);
+crcea_int crcea_update_zeros(const crcea_context *cc, uint64_t n, crcea_int state);
+crcea_int crcea_update_repeat(const crcea_context *cc, const void *src, const void *srcend, uint64_t times, crcea_int state);
+crcea_int crcea_unupdate(const crcea_context *cc, const void *src, const void *srcend, crcea_int state);
 crcea_int crcea_finish(const crcea_context *cc, crcea_int state);
 crcea_int crcea(const crcea_context *cc, const void *src, const void *srcend, crcea_int crc);
+crcea_int crcea_update_parallel(crcea_context *cc, const void *src, const void *srcend, crcea_int state, int threads);
+void crcea_parallel_shutdown(void);
+crcea_int crcea_combine(const crcea_context *cc, crcea_int crca, crcea_int crcb, uint64_t lenb);
+crcea_int crcea_patch(const crcea_context *cc, crcea_int crc, uint64_t total, uint64_t offset, const void *oldbytes, const void *newbytes, size_t n);
+int crcea_rolling_setup(crcea_rolling *rc, const crcea_context *cc, uint64_t window, crcea_int crc);
+void crcea_rolling_release(crcea_rolling *rc, const crcea_context *cc);
+crcea_int crcea_rolling_roll(crcea_rolling *rc, int out, int in);
+crcea_int crcea_rolling_crc(const crcea_rolling *rc);
+int crcea_compile(crcea_context *cc, crcea_compiled *compiled);
+int crcea_length_class(size_t len);
+int crcea_autotune(crcea_context *cc, int flags, crcea_tuning *tuning);
+int crcea_tuning_apply(crcea_context *cc, const crcea_tuning *tuning, int lengthclass);
+int crcea_adaptive_setup(crcea_context *cc, crcea_adaptive *adaptive, int small, int large, uint32_t interval);
 
 #endif /* CRCEA_H__ */
@@ -0,0 +1,346 @@
+/**
+ * @file _clmul.h
+ * @brief 汎用 CRC 生成器
+ * @author dearblue <dearblue@users.osdn.me>
+ * @license Creative Commons Zero License (CC0 / Public Domain)
+ *
+ * Folding with carry-less multiplication (PCLMULQDQ) and Barrett reduction.
+ *
+ * The CRC of n bits and the generator polynomial P is computed as if it were
+ * a 64-bit CRC with G = P * x^(64 - n).
+ * Because (M mod G) = (M mod P) * x^(64 - n) for the aligned message,
+ * the folding and Barrett constants are derived once from any design,
+ * and the result is converted back to the state of CRCEA_TYPE.
+ *
+ * references:
+ * * Intel corp.: "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" (2009)
+ */
+
+#ifdef CRCEA_ENABLE_CLMUL_FOLD
+
+#ifndef CRCEA_CLMUL_ONCE__
+#define CRCEA_CLMUL_ONCE__ 1
+
+/*
+ * 各定数は 64 ビットの多項式 G = x^64 + poly64 に対する値。
+ * reflectin であればビット反転された値を保持する。
+ *
+ * fold[i][0] は XMM レジスタの下位 64 ビットに、fold[i][1] は上位 64 ビットに掛けられる。
+ */
+typedef struct crcea_clmul_constants
+{
+    uint64_t fold[7][2];    /* 2048, 1536, 1024, 512, 384, 256, 128 ビット先への畳み込み */
+    uint64_t barrett[2];    /* { floor(x^128 / G) - x^64, G - x^64 } */
+} crcea_clmul_constants;
+
+enum
+{
+    CRCEA_CLMUL_FOLD2048, CRCEA_CLMUL_FOLD1536, CRCEA_CLMUL_FOLD1024,
+    CRCEA_CLMUL_FOLD512, CRCEA_CLMUL_FOLD384, CRCEA_CLMUL_FOLD256, CRCEA_CLMUL_FOLD128
+};
+
+#define CRCEA_CLMUL_FOLD_THRESHOLD 64
+#define CRCEA_VPCLMUL_FOLD_THRESHOLD 512
+
+static void
+crcea_clmul_build_constants(crcea_clmul_constants *k, int reflected, uint64_t poly64)
+{
+    static const unsigned int dist[] = { 2048, 1536, 1024, 512, 384, 256, 128 };
+    crcea_gf2_modulus m;
+
+    crcea_gf2_modulus_init(&m, poly64);
+
+    for (int i = 0; i < 7; i ++) {
+        if (reflected) {
+            k->fold[i][0] = crcea_gf2_bitreflect64(crcea_gf2_xpow64(&m, dist[i] + 64 - 1));
+            k->fold[i][1] = crcea_gf2_bitreflect64(crcea_gf2_xpow64(&m, dist[i] - 1));
+        } else {
+            k->fold[i][0] = crcea_gf2_xpow64(&m, dist[i]);
+            k->fold[i][1] = crcea_gf2_xpow64(&m, dist[i] + 64);
+        }
+    }
+
+    if (reflected) {
+        k->barrett[0] = crcea_gf2_bitreflect64(m.mu);
+        k->barrett[1] = crcea_gf2_bitreflect64(poly64);
+    } else {
+        k->barrett[0] = m.mu;
+        k->barrett[1] = poly64;
+    }
+}
+
+#ifdef CRCEA_X86_64_SIMD
+
+#include <immintrin.h>
+
+#define CRCEA_CLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+
+static CRCEA_CLMUL_TARGET inline __attribute__((always_inline)) __m128i
+crcea_clmul_fold16(__m128i x, __m128i k)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                         _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+#define CRCEA_CLMUL_LOAD(P)                                                 \
+    (reflected ? _mm_loadu_si128((const __m128i *)(P)) :                    \
+                 _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(P)),    \
+                                  _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,      \
+                                               8, 9, 10, 11, 12, 13, 14, 15))) \
+
+#define CRCEA_CLMUL_STATE(STATE)                                            \
+    (reflected ? _mm_set_epi64x(0, (STATE)) : _mm_set_epi64x((STATE), 0))   \
+
+/*
+ * 畳み込まれた 128 ビットの値 x0 に残りの 16 バイト単位の入力を畳み込み、
+ * 64 ビットに揃えられた CRC の内部状態として返す。
+ */
+static CRCEA_CLMUL_TARGET inline __attribute__((always_inline)) uint64_t
+crcea_clmul_reduce(const crcea_clmul_constants *k, const int reflected, __m128i x0, const char *p, size_t len)
+{
+    const __m128i k128 = _mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD128]);
+
+    for (; len >= 16; p += 16, len -= 16) {
+        x0 = _mm_xor_si128(crcea_clmul_fold16(x0, k128), CRCEA_CLMUL_LOAD(p));
+    }
+
+    /*
+     * 128 ビットの剰余を x^64 倍して G で割る。
+     * 最初に上位 64 ビットを x^128 mod G で畳み込み、残りを Barrett 還元する。
+     */
+    const __m128i mu = _mm_loadu_si128((const __m128i *)k->barrett);
+
+    if (reflected) {
+        __m128i t = _mm_xor_si128(_mm_clmulepi64_si128(x0, k128, 0x10), _mm_srli_si128(x0, 8));
+        uint64_t th = (uint64_t)_mm_cvtsi128_si64(t);
+        uint64_t tl = (uint64_t)_mm_cvtsi128_si64(_mm_srli_si128(t, 8));
+        __m128i c = _mm_clmulepi64_si128(t, mu, 0x00);
+        uint64_t q = th ^ ((uint64_t)_mm_cvtsi128_si64(c) << 1);
+        c = _mm_clmulepi64_si128(_mm_cvtsi64_si128(q), mu, 0x10);
+        uint64_t chi = (uint64_t)_mm_cvtsi128_si64(_mm_srli_si128(c, 8));
+        uint64_t clo = (uint64_t)_mm_cvtsi128_si64(c);
+        return tl ^ (chi << 1) ^ (clo >> 63);
+    } else {
+        __m128i t = _mm_xor_si128(_mm_clmulepi64_si128(x0, k128, 0x01), _mm_slli_si128(x0, 8));
+        uint64_t th = (uint64_t)_mm_cvtsi128_si64(_mm_srli_si128(t, 8));
+        uint64_t tl = (uint64_t)_mm_cvtsi128_si64(t);
+        __m128i c = _mm_clmulepi64_si128(_mm_srli_si128(t, 8), mu, 0x00);
+        uint64_t q = th ^ (uint64_t)_mm_cvtsi128_si64(_mm_srli_si128(c, 8));
+        c = _mm_clmulepi64_si128(_mm_cvtsi64_si128(q), mu, 0x10);
+        return tl ^ (uint64_t)_mm_cvtsi128_si64(c);
+    }
+}
+
+/*
+ * state は 64 ビットに揃えられた CRC の内部状態。
+ * len は 64 以上の 16 の倍数であること。
+ */
+static CRCEA_CLMUL_TARGET inline __attribute__((always_inline)) uint64_t
+crcea_clmul_fold(const crcea_clmul_constants *k, const int reflected, const char *p, size_t len, uint64_t state)
+{
+    const __m128i k512 = _mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD512]);
+    __m128i x0, x1, x2, x3;
+
+    x0 = _mm_xor_si128(CRCEA_CLMUL_LOAD(p +  0), CRCEA_CLMUL_STATE(state));
+    x1 = CRCEA_CLMUL_LOAD(p + 16);
+    x2 = CRCEA_CLMUL_LOAD(p + 32);
+    x3 = CRCEA_CLMUL_LOAD(p + 48);
+
+    for (p += 64, len -= 64; len >= 64; p += 64, len -= 64) {
+        x0 = _mm_xor_si128(crcea_clmul_fold16(x0, k512), CRCEA_CLMUL_LOAD(p +  0));
+        x1 = _mm_xor_si128(crcea_clmul_fold16(x1, k512), CRCEA_CLMUL_LOAD(p + 16));
+        x2 = _mm_xor_si128(crcea_clmul_fold16(x2, k512), CRCEA_CLMUL_LOAD(p + 32));
+        x3 = _mm_xor_si128(crcea_clmul_fold16(x3, k512), CRCEA_CLMUL_LOAD(p + 48));
+    }
+
+    x0 = crcea_clmul_fold16(x0, _mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD384]));
+    x1 = crcea_clmul_fold16(x1, _mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD256]));
+    x2 = crcea_clmul_fold16(x2, _mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD128]));
+    x0 = _mm_xor_si128(_mm_xor_si128(x0, x1), _mm_xor_si128(x2, x3));
+
+    return crcea_clmul_reduce(k, reflected, x0, p, len);
+}
+
+static CRCEA_CLMUL_TARGET uint64_t
+crcea_clmul_fold_reflected(const crcea_clmul_constants *k, const char *p, size_t len, uint64_t state)
+{
+    return crcea_clmul_fold(k, 1, p, len, state);
+}
+
+static CRCEA_CLMUL_TARGET uint64_t
+crcea_clmul_fold_normal(const crcea_clmul_constants *k, const char *p, size_t len, uint64_t state)
+{
+    return crcea_clmul_fold(k, 0, p, len, state);
+}
+
+static int
+crcea_clmul_available(void)
+{
+    return crcea_cpu_supports(CRCEA_CPU_PCLMUL | CRCEA_CPU_SSSE3);
+}
+
+#ifdef CRCEA_ENABLE_VPCLMUL_FOLD
+
+#define CRCEA_VPCLMUL_TARGET __attribute__((target("pclmul,ssse3,avx512f,avx512bw,vpclmulqdq")))
+
+static CRCEA_VPCLMUL_TARGET inline __attribute__((always_inline)) __m512i
+crcea_vpclmul_fold64(__m512i x, __m512i k)
+{
+    return _mm512_xor_si512(_mm512_clmulepi64_epi128(x, k, 0x00),
+                            _mm512_clmulepi64_epi128(x, k, 0x11));
+}
+
+/*
+ * 4 つの ZMM レジスタ (16 個の 128 ビットの列) で 256 バイト単位に畳み込む。
+ * len は 256 以上の 16 の倍数であること。
+ */
+static CRCEA_VPCLMUL_TARGET inline __attribute__((always_inline)) uint64_t
+crcea_vpclmul_fold(const crcea_clmul_constants *k, const int reflected, const char *p, size_t len, uint64_t state)
+{
+    const __m512i bswap = _mm512_broadcast_i32x4(_mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    const __m512i k2048 = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD2048]));
+    __m512i x0, x1, x2, x3;
+
+#define CRCEA_VPCLMUL_LOAD(P)                                               \
+    (reflected ? _mm512_loadu_si512((const void *)(P)) :                    \
+                 _mm512_shuffle_epi8(_mm512_loadu_si512((const void *)(P)), bswap)) \
+
+    x0 = _mm512_xor_si512(CRCEA_VPCLMUL_LOAD(p +   0),
+                          _mm512_inserti32x4(_mm512_setzero_si512(), CRCEA_CLMUL_STATE(state), 0));
+    x1 = CRCEA_VPCLMUL_LOAD(p +  64);
+    x2 = CRCEA_VPCLMUL_LOAD(p + 128);
+    x3 = CRCEA_VPCLMUL_LOAD(p + 192);
+
+    for (p += 256, len -= 256; len >= 256; p += 256, len -= 256) {
+        x0 = _mm512_xor_si512(crcea_vpclmul_fold64(x0, k2048), CRCEA_VPCLMUL_LOAD(p +   0));
+        x1 = _mm512_xor_si512(crcea_vpclmul_fold64(x1, k2048), CRCEA_VPCLMUL_LOAD(p +  64));
+        x2 = _mm512_xor_si512(crcea_vpclmul_fold64(x2, k2048), CRCEA_VPCLMUL_LOAD(p + 128));
+        x3 = _mm512_xor_si512(crcea_vpclmul_fold64(x3, k2048), CRCEA_VPCLMUL_LOAD(p + 192));
+    }
+
+#undef CRCEA_VPCLMUL_LOAD
+
+    x0 = crcea_vpclmul_fold64(x0, _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD1536])));
+    x1 = crcea_vpclmul_fold64(x1, _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD1024])));
+    x2 = crcea_vpclmul_fold64(x2, _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD512])));
+    x0 = _mm512_xor_si512(_mm512_xor_si512(x0, x1), _mm512_xor_si512(x2, x3));
+
+    /* ZMM レジスタの 4 つの列を 1 つの XMM レジスタへ畳み込む */
+    __m128i y0 = crcea_clmul_fold16(_mm512_extracti32x4_epi32(x0, 0), _mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD384]));
+    __m128i y1 = crcea_clmul_fold16(_mm512_extracti32x4_epi32(x0, 1), _mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD256]));
+    __m128i y2 = crcea_clmul_fold16(_mm512_extracti32x4_epi32(x0, 2), _mm_loadu_si128((const __m128i *)k->fold[CRCEA_CLMUL_FOLD128]));
+    y0 = _mm_xor_si128(_mm_xor_si128(y0, y1), _mm_xor_si128(y2, _mm512_extracti32x4_epi32(x0, 3)));
+
+    return crcea_clmul_reduce(k, reflected, y0, p, len);
+}
+
+static CRCEA_VPCLMUL_TARGET uint64_t
+crcea_vpclmul_fold_reflected(const crcea_clmul_constants *k, const char *p, size_t len, uint64_t state)
+{
+    return crcea_vpclmul_fold(k, 1, p, len, state);
+}
+
+static CRCEA_VPCLMUL_TARGET uint64_t
+crcea_vpclmul_fold_normal(const crcea_clmul_constants *k, const char *p, size_t len, uint64_t state)
+{
+    return crcea_vpclmul_fold(k, 0, p, len, state);
+}
+
+static int
+crcea_vpclmul_available(void)
+{
+    return crcea_cpu_supports(CRCEA_CPU_PCLMUL | CRCEA_CPU_SSSE3 | CRCEA_CPU_AVX512F |
+                              CRCEA_CPU_AVX512BW | CRCEA_CPU_VPCLMULQDQ);
+}
+
+#endif /* CRCEA_ENABLE_VPCLMUL_FOLD */
+
+#undef CRCEA_CLMUL_LOAD
+#undef CRCEA_CLMUL_STATE
+
+#endif /* CRCEA_X86_64_SIMD */
+
+#endif /* CRCEA_CLMUL_ONCE__ */
+
+CRCEA_VISIBILITY CRCEA_INLINE void
+CRCEA_CLMUL_BUILD_CONSTANTS(const crcea_design *design, void *table)
+{
+    if (CRCEA_BITSIZE > 64) {
+        return;     /* 64 ビットを超える内部状態では後ろのテーブルだけを用いる */
+    }
+
+    uint64_t poly64 = (uint64_t)(design->polynomial & CRCEA_BITMASK(design->bitsize)) << (64 - design->bitsize);
+
+    crcea_clmul_build_constants((crcea_clmul_constants *)table, design->reflectin, poly64);
+}
+
+/*
+ * Folding by carry-less multiplication
+ *
+ * The 64-byte blocks are folded with four XMM registers,
+ * and the remaining bytes are done by the standard table.
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_UPDATE_CLMUL_FOLD(const crcea_design *design, const char *p, const char *pp, CRCEA_TYPE state, const void *table)
+{
+    const CRCEA_TYPE *t = (const CRCEA_TYPE *)((const char *)table + sizeof(crcea_clmul_constants));
+
+#ifdef CRCEA_X86_64_SIMD
+    if (CRCEA_BITSIZE <= 64 && pp - p >= CRCEA_CLMUL_FOLD_THRESHOLD && crcea_clmul_available()) {
+        size_t len = (size_t)(pp - p) & ~(size_t)15;
+
+        if (design->reflectin) {
+            state = (CRCEA_TYPE)crcea_clmul_fold_reflected((const crcea_clmul_constants *)table, p, len, (uint64_t)state);
+        } else {
+            uint64_t s = (uint64_t)state << (64 - CRCEA_BITSIZE);
+            state = (CRCEA_TYPE)(crcea_clmul_fold_normal((const crcea_clmul_constants *)table, p, len, s) >> (64 - CRCEA_BITSIZE));
+        }
+
+        p += len;
+    }
+#endif
+
+#define CRCEA_CLMUL_FOLD_DECL(IN, END, ADAPT, INPUT, SHIFT, SLICE, SLICE8, LOAD16, INDEX16) \
+    CRCEA_UPDATE_STRIPE(IN, END, 1);                                        \
+        state = SHIFT(state, 8) ^ t[(uint8_t)*IN ^ SLICE(state, 0, 8)];     \
+    CRCEA_UPDATE_BYTE(IN, END);                                             \
+        state = SHIFT(state, 8) ^ t[(uint8_t)*IN ^ SLICE(state, 0, 8)];     \
+    CRCEA_UPDATE_END();                                                     \
+
+    CRCEA_UPDATE_DECL(design, p, pp, state, CRCEA_CLMUL_FOLD_DECL);
+
+    return state;
+}
+
+#ifdef CRCEA_ENABLE_VPCLMUL_FOLD
+
+/*
+ * Folding by carry-less multiplication with AVX-512
+ *
+ * The 256-byte blocks are folded with four ZMM registers by VPCLMULQDQ,
+ * and the rest is done by CRCEA_CLMUL_FOLD with the same table.
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_UPDATE_VPCLMUL_FOLD(const crcea_design *design, const char *p, const char *pp, CRCEA_TYPE state, const void *table)
+{
+#ifdef CRCEA_X86_64_SIMD
+    if (CRCEA_BITSIZE <= 64 && pp - p >= CRCEA_VPCLMUL_FOLD_THRESHOLD && crcea_vpclmul_available()) {
+        size_t len = (size_t)(pp - p) & ~(size_t)15;
+
+        if (design->reflectin) {
+            state = (CRCEA_TYPE)crcea_vpclmul_fold_reflected((const crcea_clmul_constants *)table, p, len, (uint64_t)state);
+        } else {
+            uint64_t s = (uint64_t)state << (64 - CRCEA_BITSIZE);
+            state = (CRCEA_TYPE)(crcea_vpclmul_fold_normal((const crcea_clmul_constants *)table, p, len, s) >> (64 - CRCEA_BITSIZE));
+        }
+
+        p += len;
+    }
+#endif
+
+    return CRCEA_UPDATE_CLMUL_FOLD(design, p, pp, state, table);
+}
+
+#endif /* CRCEA_ENABLE_VPCLMUL_FOLD */
+
+#endif /* CRCEA_ENABLE_CLMUL_FOLD */
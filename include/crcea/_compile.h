@@ -0,0 +1,356 @@
+/**
+ * @file _compile.h
+ * @brief 汎用 CRC 生成器
+ * @author dearblue <dearblue@users.osdn.me>
+ * @license Creative Commons Zero License (CC0 / Public Domain)
+ *
+ * Entry points of crcea_compiled.
+ *
+ * Each algorithm has its own update function of the crcea_update_f form,
+ * so the type width and the algorithm are resolved only once by
+ * CRCEA_COMPILE_UPDATE() instead of on every call.
+ */
+
+static inline crcea_int
+CRCEA_COMPILED_SETUP(const crcea_design *design, crcea_int crc)
+{
+    return CRCEA_SETUP(design, (CRCEA_TYPE)crc);
+}
+
+static inline crcea_int
+CRCEA_COMPILED_FINISH(const crcea_design *design, crcea_int state)
+{
+    return CRCEA_FINISH(design, (CRCEA_TYPE)state);
+}
+
+/*
+ * appendzero が偽である場合などの、アルゴリズムを直接呼び出せない場合の更新関数
+ */
+static inline crcea_int
+CRCEA_COMPILED_UPDATE(const crcea_compiled *cp, const void *src, const void *srcend, crcea_int state)
+{
+    return CRCEA_UPDATE(cp->design, (const char *)src, (const char *)srcend, (CRCEA_TYPE)state, cp->algorithm, cp->table);
+}
+
+#define CRCEA_COMPILED_KERNEL(NAME, KERNEL)                                 \
+    static inline crcea_int                                                 \
+    CRCEA_TOKEN(_compiled_ ## NAME)(const crcea_compiled *cp, const void *src, const void *srcend, crcea_int state) \
+    {                                                                       \
+        return KERNEL(cp->design, (const char *)src, (const char *)srcend, (CRCEA_TYPE)state, cp->table); \
+    }                                                                       \
+
+#define CRCEA_COMPILED_BITWISE(NAME, KERNEL)                                \
+    static inline crcea_int                                                 \
+    CRCEA_TOKEN(_compiled_ ## NAME)(const crcea_compiled *cp, const void *src, const void *srcend, crcea_int state) \
+    {                                                                       \
+        return KERNEL(cp->design, (const char *)src, (const char *)srcend, (CRCEA_TYPE)state); \
+    }                                                                       \
+
+#define CRCEA_COMPILED_CASE(ALGO, NAME)                                     \
+    case ALGO:                                                              \
+        return CRCEA_TOKEN(_compiled_ ## NAME);                             \
+
+CRCEA_COMPILED_BITWISE(fallback, CRCEA_UPDATE_FALLBACK)
+#ifdef CRCEA_ENABLE_BITWISE_CONDXOR
+CRCEA_COMPILED_BITWISE(bitwise_condxor, CRCEA_UPDATE_BITWISE_CONDXOR)
+#endif
+#ifdef CRCEA_ENABLE_BITWISE_BRANCHASSIGN
+CRCEA_COMPILED_BITWISE(bitwise_branchassign, CRCEA_UPDATE_BITWISE_BRANCHASSIGN)
+#endif
+#ifdef CRCEA_ENABLE_BITWISE_BRANCHMIX
+CRCEA_COMPILED_BITWISE(bitwise_branchmix, CRCEA_UPDATE_BITWISE_BRANCHMIX)
+#endif
+#ifdef CRCEA_ENABLE_BITWISE_BRANCHLESS
+CRCEA_COMPILED_BITWISE(bitwise_branchless, CRCEA_UPDATE_BITWISE_BRANCHLESS)
+#endif
+#ifdef CRCEA_ENABLE_BITCOMBINE2
+CRCEA_COMPILED_BITWISE(bitcombine2, CRCEA_UPDATE_BITCOMBINE2)
+#endif
+#ifdef CRCEA_ENABLE_BITCOMBINE4
+CRCEA_COMPILED_BITWISE(bitcombine4, CRCEA_UPDATE_BITCOMBINE4)
+#endif
+#ifdef CRCEA_ENABLE_BITCOMBINE8
+CRCEA_COMPILED_BITWISE(bitcombine8, CRCEA_UPDATE_BITCOMBINE8)
+#endif
+#ifdef CRCEA_ENABLE_BITCOMBINE16
+CRCEA_COMPILED_BITWISE(bitcombine16, CRCEA_UPDATE_BITCOMBINE16)
+#endif
+#ifdef CRCEA_ENABLE_BITCOMBINE32
+CRCEA_COMPILED_BITWISE(bitcombine32, CRCEA_UPDATE_BITCOMBINE32)
+#endif
+#ifdef CRCEA_ENABLE_BY_SOLO
+CRCEA_COMPILED_KERNEL(by_solo, CRCEA_UPDATE_BY_SOLO)
+#endif
+#ifdef CRCEA_ENABLE_BY1_SOLO
+CRCEA_COMPILED_KERNEL(by1_solo, CRCEA_UPDATE_BY1_SOLO)
+#endif
+#ifdef CRCEA_ENABLE_BY2_SOLO
+CRCEA_COMPILED_KERNEL(by2_solo, CRCEA_UPDATE_BY2_SOLO)
+#endif
+#ifdef CRCEA_ENABLE_BY4_SOLO
+CRCEA_COMPILED_KERNEL(by4_solo, CRCEA_UPDATE_BY4_SOLO)
+#endif
+#ifdef CRCEA_ENABLE_BY8_SOLO
+CRCEA_COMPILED_KERNEL(by8_solo, CRCEA_UPDATE_BY8_SOLO)
+#endif
+#ifdef CRCEA_ENABLE_BY16_SOLO
+CRCEA_COMPILED_KERNEL(by16_solo, CRCEA_UPDATE_BY16_SOLO)
+#endif
+#ifdef CRCEA_ENABLE_BY32_SOLO
+CRCEA_COMPILED_KERNEL(by32_solo, CRCEA_UPDATE_BY32_SOLO)
+#endif
+#ifdef CRCEA_ENABLE_BY_DUO
+CRCEA_COMPILED_KERNEL(by_duo, CRCEA_UPDATE_BY_DUO)
+#endif
+#ifdef CRCEA_ENABLE_BY1_DUO
+CRCEA_COMPILED_KERNEL(by1_duo, CRCEA_UPDATE_BY1_DUO)
+#endif
+#ifdef CRCEA_ENABLE_BY2_DUO
+CRCEA_COMPILED_KERNEL(by2_duo, CRCEA_UPDATE_BY2_DUO)
+#endif
+#ifdef CRCEA_ENABLE_BY4_DUO
+CRCEA_COMPILED_KERNEL(by4_duo, CRCEA_UPDATE_BY4_DUO)
+#endif
+#ifdef CRCEA_ENABLE_BY8_DUO
+CRCEA_COMPILED_KERNEL(by8_duo, CRCEA_UPDATE_BY8_DUO)
+#endif
+#ifdef CRCEA_ENABLE_BY16_DUO
+CRCEA_COMPILED_KERNEL(by16_duo, CRCEA_UPDATE_BY16_DUO)
+#endif
+#ifdef CRCEA_ENABLE_BY32_DUO
+CRCEA_COMPILED_KERNEL(by32_duo, CRCEA_UPDATE_BY32_DUO)
+#endif
+#ifdef CRCEA_ENABLE_BY_QUARTET
+CRCEA_COMPILED_KERNEL(by_quartet, CRCEA_UPDATE_BY_QUARTET)
+#endif
+#ifdef CRCEA_ENABLE_BY1_QUARTET
+CRCEA_COMPILED_KERNEL(by1_quartet, CRCEA_UPDATE_BY1_QUARTET)
+#endif
+#ifdef CRCEA_ENABLE_BY2_QUARTET
+CRCEA_COMPILED_KERNEL(by2_quartet, CRCEA_UPDATE_BY2_QUARTET)
+#endif
+#ifdef CRCEA_ENABLE_BY4_QUARTET
+CRCEA_COMPILED_KERNEL(by4_quartet, CRCEA_UPDATE_BY4_QUARTET)
+#endif
+#ifdef CRCEA_ENABLE_BY8_QUARTET
+CRCEA_COMPILED_KERNEL(by8_quartet, CRCEA_UPDATE_BY8_QUARTET)
+#endif
+#ifdef CRCEA_ENABLE_BY16_QUARTET
+CRCEA_COMPILED_KERNEL(by16_quartet, CRCEA_UPDATE_BY16_QUARTET)
+#endif
+#ifdef CRCEA_ENABLE_BY32_QUARTET
+CRCEA_COMPILED_KERNEL(by32_quartet, CRCEA_UPDATE_BY32_QUARTET)
+#endif
+#ifdef CRCEA_ENABLE_BY1_OCTET
+CRCEA_COMPILED_KERNEL(by1_octet, CRCEA_UPDATE_BY1_OCTET)
+#endif
+#ifdef CRCEA_ENABLE_BY2_OCTET
+CRCEA_COMPILED_KERNEL(by2_octet, CRCEA_UPDATE_BY2_OCTET)
+#endif
+#ifdef CRCEA_ENABLE_BY4_OCTET
+CRCEA_COMPILED_KERNEL(by4_octet, CRCEA_UPDATE_BY4_OCTET)
+#endif
+#ifdef CRCEA_ENABLE_BY8_OCTET
+CRCEA_COMPILED_KERNEL(by8_octet, CRCEA_UPDATE_BY8_OCTET)
+#endif
+#ifdef CRCEA_ENABLE_BY16_OCTET
+CRCEA_COMPILED_KERNEL(by16_octet, CRCEA_UPDATE_BY16_OCTET)
+#endif
+#ifdef CRCEA_ENABLE_BY32_OCTET
+CRCEA_COMPILED_KERNEL(by32_octet, CRCEA_UPDATE_BY32_OCTET)
+#endif
+#ifdef CRCEA_ENABLE_BY8_OCTET_2WAY
+CRCEA_COMPILED_KERNEL(by8_octet_2way, CRCEA_UPDATE_BY8_OCTET_2WAY)
+#endif
+#ifdef CRCEA_ENABLE_BY2_SEXDECTET
+CRCEA_COMPILED_KERNEL(by2_sexdectet, CRCEA_UPDATE_BY2_SEXDECTET)
+#endif
+#ifdef CRCEA_ENABLE_BY4_SEXDECTET
+CRCEA_COMPILED_KERNEL(by4_sexdectet, CRCEA_UPDATE_BY4_SEXDECTET)
+#endif
+#ifdef CRCEA_ENABLE_BY8_SEXDECTET
+CRCEA_COMPILED_KERNEL(by8_sexdectet, CRCEA_UPDATE_BY8_SEXDECTET)
+#endif
+#ifdef CRCEA_ENABLE_BY16_SEXDECTET
+CRCEA_COMPILED_KERNEL(by16_sexdectet, CRCEA_UPDATE_BY16_SEXDECTET)
+#endif
+#ifdef CRCEA_ENABLE_BY32_SEXDECTET
+CRCEA_COMPILED_KERNEL(by32_sexdectet, CRCEA_UPDATE_BY32_SEXDECTET)
+#endif
+#ifdef CRCEA_ENABLE_CLMUL_FOLD
+CRCEA_COMPILED_KERNEL(clmul_fold, CRCEA_UPDATE_CLMUL_FOLD)
+#endif
+#ifdef CRCEA_ENABLE_VPCLMUL_FOLD
+CRCEA_COMPILED_KERNEL(vpclmul_fold, CRCEA_UPDATE_VPCLMUL_FOLD)
+#endif
+#ifdef CRCEA_ENABLE_SSE42_CRC32C
+CRCEA_COMPILED_KERNEL(sse42_crc32c, CRCEA_UPDATE_SSE42_CRC32C)
+#endif
+
+/*
+ * design と algo (CRCEA_AUTOMATIC は解決済みであること) に対する更新関数を返す。
+ *
+ * appendzero が偽である場合と CRCEA_REFERENCE は CRCEA_UPDATE を経由する。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE crcea_update_f *
+CRCEA_COMPILE_UPDATE(const crcea_design *design, int algo, const void *table)
+{
+    if (!design->appendzero) {
+        return CRCEA_COMPILED_UPDATE;
+    }
+
+    if (table == NULL && algo >= CRCEA_TABLE_ALGORITHM) {
+        algo = CRCEA_FALLBACK;
+    }
+
+    switch (algo) {
+#ifdef CRCEA_ENABLE_BITWISE_CONDXOR
+    CRCEA_COMPILED_CASE(CRCEA_BITWISE_CONDXOR, bitwise_condxor);
+#endif
+#ifdef CRCEA_ENABLE_BITWISE_BRANCHASSIGN
+    CRCEA_COMPILED_CASE(CRCEA_BITWISE_BRANCHASSIGN, bitwise_branchassign);
+#endif
+#ifdef CRCEA_ENABLE_BITWISE_BRANCHMIX
+    CRCEA_COMPILED_CASE(CRCEA_BITWISE_BRANCHMIX, bitwise_branchmix);
+#endif
+#ifdef CRCEA_ENABLE_BITWISE_BRANCHLESS
+    CRCEA_COMPILED_CASE(CRCEA_BITWISE_BRANCHLESS, bitwise_branchless);
+#endif
+#ifdef CRCEA_ENABLE_BITCOMBINE2
+    CRCEA_COMPILED_CASE(CRCEA_BITCOMBINE2, bitcombine2);
+#endif
+#ifdef CRCEA_ENABLE_BITCOMBINE4
+    CRCEA_COMPILED_CASE(CRCEA_BITCOMBINE4, bitcombine4);
+#endif
+#ifdef CRCEA_ENABLE_BITCOMBINE8
+    CRCEA_COMPILED_CASE(CRCEA_BITCOMBINE8, bitcombine8);
+#endif
+#ifdef CRCEA_ENABLE_BITCOMBINE16
+    CRCEA_COMPILED_CASE(CRCEA_BITCOMBINE16, bitcombine16);
+#endif
+#ifdef CRCEA_ENABLE_BITCOMBINE32
+    CRCEA_COMPILED_CASE(CRCEA_BITCOMBINE32, bitcombine32);
+#endif
+#ifdef CRCEA_ENABLE_BY_SOLO
+    CRCEA_COMPILED_CASE(CRCEA_BY_SOLO, by_solo);
+#endif
+#ifdef CRCEA_ENABLE_BY1_SOLO
+    CRCEA_COMPILED_CASE(CRCEA_BY1_SOLO, by1_solo);
+#endif
+#ifdef CRCEA_ENABLE_BY2_SOLO
+    CRCEA_COMPILED_CASE(CRCEA_BY2_SOLO, by2_solo);
+#endif
+#ifdef CRCEA_ENABLE_BY4_SOLO
+    CRCEA_COMPILED_CASE(CRCEA_BY4_SOLO, by4_solo);
+#endif
+#ifdef CRCEA_ENABLE_BY8_SOLO
+    CRCEA_COMPILED_CASE(CRCEA_BY8_SOLO, by8_solo);
+#endif
+#ifdef CRCEA_ENABLE_BY16_SOLO
+    CRCEA_COMPILED_CASE(CRCEA_BY16_SOLO, by16_solo);
+#endif
+#ifdef CRCEA_ENABLE_BY32_SOLO
+    CRCEA_COMPILED_CASE(CRCEA_BY32_SOLO, by32_solo);
+#endif
+#ifdef CRCEA_ENABLE_BY_DUO
+    CRCEA_COMPILED_CASE(CRCEA_BY_DUO, by_duo);
+#endif
+#ifdef CRCEA_ENABLE_BY1_DUO
+    CRCEA_COMPILED_CASE(CRCEA_BY1_DUO, by1_duo);
+#endif
+#ifdef CRCEA_ENABLE_BY2_DUO
+    CRCEA_COMPILED_CASE(CRCEA_BY2_DUO, by2_duo);
+#endif
+#ifdef CRCEA_ENABLE_BY4_DUO
+    CRCEA_COMPILED_CASE(CRCEA_BY4_DUO, by4_duo);
+#endif
+#ifdef CRCEA_ENABLE_BY8_DUO
+    CRCEA_COMPILED_CASE(CRCEA_BY8_DUO, by8_duo);
+#endif
+#ifdef CRCEA_ENABLE_BY16_DUO
+    CRCEA_COMPILED_CASE(CRCEA_BY16_DUO, by16_duo);
+#endif
+#ifdef CRCEA_ENABLE_BY32_DUO
+    CRCEA_COMPILED_CASE(CRCEA_BY32_DUO, by32_duo);
+#endif
+#ifdef CRCEA_ENABLE_BY_QUARTET
+    CRCEA_COMPILED_CASE(CRCEA_BY_QUARTET, by_quartet);
+#endif
+#ifdef CRCEA_ENABLE_BY1_QUARTET
+    CRCEA_COMPILED_CASE(CRCEA_BY1_QUARTET, by1_quartet);
+#endif
+#ifdef CRCEA_ENABLE_BY2_QUARTET
+    CRCEA_COMPILED_CASE(CRCEA_BY2_QUARTET, by2_quartet);
+#endif
+#ifdef CRCEA_ENABLE_BY4_QUARTET
+    CRCEA_COMPILED_CASE(CRCEA_BY4_QUARTET, by4_quartet);
+#endif
+#ifdef CRCEA_ENABLE_BY8_QUARTET
+    CRCEA_COMPILED_CASE(CRCEA_BY8_QUARTET, by8_quartet);
+#endif
+#ifdef CRCEA_ENABLE_BY16_QUARTET
+    CRCEA_COMPILED_CASE(CRCEA_BY16_QUARTET, by16_quartet);
+#endif
+#ifdef CRCEA_ENABLE_BY32_QUARTET
+    CRCEA_COMPILED_CASE(CRCEA_BY32_QUARTET, by32_quartet);
+#endif
+#ifdef CRCEA_ENABLE_BY1_OCTET
+    CRCEA_COMPILED_CASE(CRCEA_BY1_OCTET, by1_octet);
+#endif
+#ifdef CRCEA_ENABLE_BY2_OCTET
+    CRCEA_COMPILED_CASE(CRCEA_BY2_OCTET, by2_octet);
+#endif
+#ifdef CRCEA_ENABLE_BY4_OCTET
+    CRCEA_COMPILED_CASE(CRCEA_BY4_OCTET, by4_octet);
+#endif
+#ifdef CRCEA_ENABLE_BY8_OCTET
+    CRCEA_COMPILED_CASE(CRCEA_BY8_OCTET, by8_octet);
+#endif
+#ifdef CRCEA_ENABLE_BY16_OCTET
+    CRCEA_COMPILED_CASE(CRCEA_BY16_OCTET, by16_octet);
+#endif
+#ifdef CRCEA_ENABLE_BY32_OCTET
+    CRCEA_COMPILED_CASE(CRCEA_BY32_OCTET, by32_octet);
+#endif
+#ifdef CRCEA_ENABLE_BY8_OCTET_2WAY
+    CRCEA_COMPILED_CASE(CRCEA_BY8_OCTET_2WAY, by8_octet_2way);
+#endif
+#ifdef CRCEA_ENABLE_BY2_SEXDECTET
+    CRCEA_COMPILED_CASE(CRCEA_BY2_SEXDECTET, by2_sexdectet);
+#endif
+#ifdef CRCEA_ENABLE_BY4_SEXDECTET
+    CRCEA_COMPILED_CASE(CRCEA_BY4_SEXDECTET, by4_sexdectet);
+#endif
+#ifdef CRCEA_ENABLE_BY8_SEXDECTET
+    CRCEA_COMPILED_CASE(CRCEA_BY8_SEXDECTET, by8_sexdectet);
+#endif
+#ifdef CRCEA_ENABLE_BY16_SEXDECTET
+    CRCEA_COMPILED_CASE(CRCEA_BY16_SEXDECTET, by16_sexdectet);
+#endif
+#ifdef CRCEA_ENABLE_BY32_SEXDECTET
+    CRCEA_COMPILED_CASE(CRCEA_BY32_SEXDECTET, by32_sexdectet);
+#endif
+#ifdef CRCEA_ENABLE_CLMUL_FOLD
+    CRCEA_COMPILED_CASE(CRCEA_CLMUL_FOLD, clmul_fold);
+#endif
+#ifdef CRCEA_ENABLE_VPCLMUL_FOLD
+    CRCEA_COMPILED_CASE(CRCEA_VPCLMUL_FOLD, vpclmul_fold);
+#endif
+#ifdef CRCEA_ENABLE_SSE42_CRC32C
+    CRCEA_COMPILED_CASE(CRCEA_SSE42_CRC32C, sse42_crc32c);
+#endif
+
+#ifdef CRCEA_ENABLE_REFERENCE
+    case CRCEA_REFERENCE:
+        return CRCEA_COMPILED_UPDATE;
+#endif
+
+    case CRCEA_FALLBACK:
+    default:
+        return CRCEA_TOKEN(_compiled_fallback);
+    }
+}
+
+#undef CRCEA_COMPILED_KERNEL
+#undef CRCEA_COMPILED_BITWISE
+#undef CRCEA_COMPILED_CASE
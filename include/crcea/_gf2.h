@@ -0,0 +1,326 @@
+/**
+ * @file _gf2.h
+ * @brief 汎用 CRC 生成器
+ * @author dearblue <dearblue@users.osdn.me>
+ * @license Creative Commons Zero License (CC0 / Public Domain)
+ *
+ * Polynomial arithmetic over GF(2) modulo the generator polynomial.
+ *
+ * The values are kept in the same form as the CRC state of CRCEA_TYPE.
+ * The multiplication is done by PCLMULQDQ and Barrett reduction on the
+ * 64-bit aligned polynomial G = P * x^(64 - n) where available,
+ * and by the portable shift and xor code elsewhere.
+ */
+
+#ifndef CRCEA_GF2_ONCE__
+#define CRCEA_GF2_ONCE__ 1
+
+/*
+ * 64 ビットの多項式 G = x^64 + poly64 を法とする演算のための値。
+ */
+typedef struct crcea_gf2_modulus
+{
+    uint64_t poly64;
+    uint64_t mu;            /* floor(x^128 / G) - x^64 */
+} crcea_gf2_modulus;
+
+static inline uint64_t
+crcea_gf2_bitreflect64(uint64_t n)
+{
+    n = ((n >> 32) & 0x00000000ffffffffull) | ( n                          << 32);
+    n = ((n >> 16) & 0x0000ffff0000ffffull) | ((n & 0x0000ffff0000ffffull) << 16);
+    n = ((n >>  8) & 0x00ff00ff00ff00ffull) | ((n & 0x00ff00ff00ff00ffull) <<  8);
+    n = ((n >>  4) & 0x0f0f0f0f0f0f0f0full) | ((n & 0x0f0f0f0f0f0f0f0full) <<  4);
+    n = ((n >>  2) & 0x3333333333333333ull) | ((n & 0x3333333333333333ull) <<  2);
+    n = ((n >>  1) & 0x5555555555555555ull) | ((n & 0x5555555555555555ull) <<  1);
+    return n;
+}
+
+/*
+ * floor(x^128 / G) - x^64
+ */
+static inline uint64_t
+crcea_gf2_barrett_mu(uint64_t poly64)
+{
+    uint64_t hi = poly64, mu = 0;
+
+    for (int i = 63; i >= 0; i --) {
+        if ((hi >> i) & 1) {
+            mu |= (uint64_t)1 << i;
+            hi ^= (uint64_t)1 << i;
+            if (i > 0) { hi ^= poly64 >> (64 - i); }
+        }
+    }
+
+    return mu;
+}
+
+static inline void
+crcea_gf2_modulus_init(crcea_gf2_modulus *m, uint64_t poly64)
+{
+    m->poly64 = poly64;
+    m->mu = crcea_gf2_barrett_mu(poly64);
+}
+
+#ifdef CRCEA_X86_64_SIMD
+
+#include <immintrin.h>
+
+#define CRCEA_GF2_TARGET __attribute__((target("pclmul")))
+
+/*
+ * a * b mod G
+ *
+ * 128 ビットの積 R の商は floor(R / x^64) * floor(x^128 / G) / x^64 で求まる。
+ */
+static CRCEA_GF2_TARGET inline uint64_t
+crcea_gf2_mulmod64_clmul(const crcea_gf2_modulus *m, uint64_t a, uint64_t b)
+{
+    __m128i r = _mm_clmulepi64_si128(_mm_cvtsi64_si128((int64_t)a), _mm_cvtsi64_si128((int64_t)b), 0x00);
+    uint64_t lo = (uint64_t)_mm_cvtsi128_si64(r);
+    uint64_t hi = (uint64_t)_mm_cvtsi128_si64(_mm_srli_si128(r, 8));
+    __m128i c = _mm_clmulepi64_si128(_mm_cvtsi64_si128((int64_t)hi), _mm_cvtsi64_si128((int64_t)m->mu), 0x00);
+    uint64_t q = hi ^ (uint64_t)_mm_cvtsi128_si64(_mm_srli_si128(c, 8));
+    c = _mm_clmulepi64_si128(_mm_cvtsi64_si128((int64_t)q), _mm_cvtsi64_si128((int64_t)m->poly64), 0x00);
+
+    return lo ^ (uint64_t)_mm_cvtsi128_si64(c);
+}
+
+static inline int
+crcea_gf2_clmul_available(void)
+{
+    return crcea_cpu_supports(CRCEA_CPU_PCLMUL);
+}
+
+#endif /* CRCEA_X86_64_SIMD */
+
+/*
+ * a * b mod G
+ */
+static inline uint64_t
+crcea_gf2_mulmod64(const crcea_gf2_modulus *m, uint64_t a, uint64_t b)
+{
+#ifdef CRCEA_X86_64_SIMD
+    if (crcea_gf2_clmul_available()) {
+        return crcea_gf2_mulmod64_clmul(m, a, b);
+    }
+#endif
+
+    uint64_t r = 0;
+
+    for (int i = 63; i >= 0; i --) {
+        r = (r << 1) ^ (m->poly64 & -(r >> 63));
+        r ^= b & -((a >> i) & 1);
+    }
+
+    return r;
+}
+
+/*
+ * x^n mod G
+ */
+static inline uint64_t
+crcea_gf2_xpow64(const crcea_gf2_modulus *m, uint64_t n)
+{
+    uint64_t r = 1;
+    int i;
+
+    for (i = 63; i >= 0 && ((n >> i) & 1) == 0; i --) { }
+
+    for (; i >= 0; i --) {
+        r = crcea_gf2_mulmod64(m, r, r);
+        if ((n >> i) & 1) {
+            r = (r << 1) ^ (m->poly64 & -(r >> 63));
+        }
+    }
+
+    return r;
+}
+
+#endif /* CRCEA_GF2_ONCE__ */
+
+/*
+ * 内部状態の表現で 1 を返す
+ */
+static inline CRCEA_TYPE
+CRCEA_GF2_ONE(const crcea_design *design)
+{
+    return (design->reflectin ?
+            (CRCEA_TYPE)1 << (design->bitsize - 1) :
+            (CRCEA_TYPE)1 << (CRCEA_BITSIZE - design->bitsize));
+}
+
+/*
+ * PCLMUL が利用できれば design の生成多項式を 64 ビットに揃えた法を m に設定して返す。
+ * 利用できなければ NULL を返し、以降の演算は移植性のある方法で行われる。
+ */
+static inline const crcea_gf2_modulus *
+CRCEA_GF2_MODULUS(const crcea_design *design, crcea_gf2_modulus *m)
+{
+#ifdef CRCEA_X86_64_SIMD
+    if (CRCEA_BITSIZE <= 64 && crcea_gf2_clmul_available()) {
+        crcea_gf2_modulus_init(m, (uint64_t)(design->polynomial & CRCEA_BITMASK(design->bitsize)) << (64 - design->bitsize));
+        return m;
+    }
+#endif
+
+    (void)design;
+    (void)m;
+
+    return NULL;
+}
+
+/*
+ * 内部状態の表現のままで a * b mod P を求める
+ */
+static inline CRCEA_TYPE
+CRCEA_GF2_MULMOD(const crcea_design *design, const crcea_gf2_modulus *mod, CRCEA_TYPE a, CRCEA_TYPE b)
+{
+#ifdef CRCEA_X86_64_SIMD
+    if (mod) {
+        /* 64 ビットに揃えた a と揃えていない b の積は、揃えられた a * b mod P になる */
+        uint64_t a64, b64, r;
+
+        if (design->reflectin) {
+            a64 = crcea_gf2_bitreflect64((uint64_t)a);
+            b64 = crcea_gf2_bitreflect64((uint64_t)b);
+        } else {
+            a64 = (uint64_t)a << (64 - CRCEA_BITSIZE);
+            b64 = (uint64_t)b << (64 - CRCEA_BITSIZE);
+        }
+
+        r = crcea_gf2_mulmod64_clmul(mod, a64, b64 >> (64 - design->bitsize));
+
+        if (design->reflectin) {
+            return (CRCEA_TYPE)crcea_gf2_bitreflect64(r);
+        } else {
+            return (CRCEA_TYPE)(r >> (64 - CRCEA_BITSIZE));
+        }
+    }
+#else
+    (void)mod;
+#endif
+
+    CRCEA_TYPE r = 0;
+
+#define CRCEA_GF2_MULMOD_DECL(IN, END, ADAPT, INPUT, SHIFT, SLICE, SLICE8, LOAD16, INDEX16) \
+    CRCEA_TYPE poly = ADAPT(design->polynomial, design->bitsize);           \
+    for (unsigned int i = 0; i < design->bitsize; i ++) {                   \
+        r = SHIFT(r, 1) ^ (poly & -(CRCEA_TYPE)SLICE(r, 0, 1));             \
+        r ^= b & -(CRCEA_TYPE)SLICE(a, i, 1);                               \
+    }                                                                       \
+
+    CRCEA_UPDATE_SIMPLE_DECL(design, p, pp, state, CRCEA_GF2_MULMOD_DECL);
+
+    return r;
+}
+
+/*
+ * 内部状態の表現のままで a^2 mod P を求める
+ */
+static inline CRCEA_TYPE
+CRCEA_GF2_SQUARE(const crcea_design *design, const crcea_gf2_modulus *mod, CRCEA_TYPE a)
+{
+    return CRCEA_GF2_MULMOD(design, mod, a, a);
+}
+
+/*
+ * 内部状態の表現のままで a * x mod P を求める
+ */
+static inline CRCEA_TYPE
+CRCEA_GF2_MULX(const crcea_design *design, CRCEA_TYPE a)
+{
+#define CRCEA_GF2_MULX_DECL(IN, END, ADAPT, INPUT, SHIFT, SLICE, SLICE8, LOAD16, INDEX16) \
+    a = SHIFT(a, 1) ^ (ADAPT(design->polynomial, design->bitsize) & -(CRCEA_TYPE)SLICE(a, 0, 1)); \
+
+    CRCEA_UPDATE_SIMPLE_DECL(design, p, pp, state, CRCEA_GF2_MULX_DECL);
+
+    return a;
+}
+
+/*
+ * 内部状態の表現で x^n mod P を求める
+ */
+static inline CRCEA_TYPE
+CRCEA_GF2_XPOW(const crcea_design *design, const crcea_gf2_modulus *mod, uint64_t n)
+{
+    CRCEA_TYPE r = CRCEA_GF2_ONE(design);
+    int i;
+
+    for (i = 63; i >= 0 && ((n >> i) & 1) == 0; i --) { }
+
+    for (; i >= 0; i --) {
+        r = CRCEA_GF2_SQUARE(design, mod, r);
+        if ((n >> i) & 1) {
+            r = CRCEA_GF2_MULX(design, r);
+        }
+    }
+
+    return r;
+}
+
+/*
+ * 内部状態の表現で x^(8 * n) mod P を求める
+ */
+static inline CRCEA_TYPE
+CRCEA_GF2_XPOW8N(const crcea_design *design, const crcea_gf2_modulus *mod, uint64_t n)
+{
+    CRCEA_TYPE r = CRCEA_GF2_XPOW(design, mod, n);
+
+    r = CRCEA_GF2_SQUARE(design, mod, r);
+    r = CRCEA_GF2_SQUARE(design, mod, r);
+    r = CRCEA_GF2_SQUARE(design, mod, r);
+
+    return r;
+}
+
+/*
+ * 内部状態の表現で a^-1 mod P を求める。逆元がなければ 0 を返す。
+ *
+ * a * x^i (0 <= i < n) を掃き出して 1 を表す組み合わせを求める。
+ * 生成多項式が既約でなくても、a と互いに素であれば求められる。
+ */
+static inline CRCEA_TYPE
+CRCEA_GF2_INVERSE(const crcea_design *design, CRCEA_TYPE a)
+{
+    CRCEA_TYPE val[CRCEA_BITSIZE], comb[CRCEA_BITSIZE], used = 0;
+    CRCEA_TYPE c = a, e = CRCEA_GF2_ONE(design);
+
+    for (unsigned int i = 0; i < design->bitsize; i ++) {
+        CRCEA_TYPE v = c, w = e;
+
+        while (v != 0) {
+            int k = CRCEA_BITSIZE - 1;
+            for (; ((v >> k) & 1) == 0; k --) { }
+
+            if ((used >> k) & 1) {
+                v ^= val[k];
+                w ^= comb[k];
+            } else {
+                val[k] = v;
+                comb[k] = w;
+                used |= (CRCEA_TYPE)1 << k;
+                break;
+            }
+        }
+
+        c = CRCEA_GF2_MULX(design, c);
+        e = CRCEA_GF2_MULX(design, e);
+    }
+
+    CRCEA_TYPE t = CRCEA_GF2_ONE(design), r = 0;
+
+    while (t != 0) {
+        int k = CRCEA_BITSIZE - 1;
+        for (; ((t >> k) & 1) == 0; k --) { }
+
+        if (((used >> k) & 1) == 0) {
+            return 0;
+        }
+
+        t ^= val[k];
+        r ^= comb[k];
+    }
+
+    return r;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file _interleave.h
+ * @brief 汎用 CRC 生成器
+ * @author dearblue <dearblue@users.osdn.me>
+ * @license Creative Commons Zero License (CC0 / Public Domain)
+ *
+ * Slicing by Octuple Octet with two interleaved lanes.
+ *
+ * The input is split into the contiguous lanes of CRCEA_INTERLEAVE_LANESIZE
+ * bytes, and each lane has its own state. The lanes are processed alternately
+ * with the same tables, so the table loads of the lanes are overlapped.
+ * The lane results are merged by the table that shifts the state over
+ * CRCEA_INTERLEAVE_LANESIZE bytes of zero.
+ *
+ * Three and four lanes were slower than two lanes, since the table loads of
+ * two lanes already fill the load ports and more lanes only add the merges.
+ */
+
+#ifdef CRCEA_ENABLE_BY8_OCTET_2WAY
+
+#ifndef CRCEA_INTERLEAVE_LANESIZE
+# define CRCEA_INTERLEAVE_LANESIZE 1024
+#endif
+
+/*
+ * CRCEA_TYPE[8][256] のテーブルの後ろに、CRCEA_INTERLEAVE_LANESIZE バイトの 0 を
+ * 入力した場合の内部状態のテーブル CRCEA_TYPE[sizeof(CRCEA_TYPE)][256] を構築する。
+ *
+ * shift[k][n] は SLICE(state, 8 * k, 8) が n である場合の寄与分。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE void
+CRCEA_INTERLEAVE_BUILD_SHIFT(const crcea_design *design, void *table)
+{
+    const CRCEA_TYPE *t = (const CRCEA_TYPE *)table;
+    CRCEA_TYPE (*shift)[256] = (CRCEA_TYPE (*)[256])((char *)table + sizeof(CRCEA_TYPE[8][256]));
+    CRCEA_TYPE col[CRCEA_BITSIZE];
+
+#define CRCEA_INTERLEAVE_BUILD_SHIFT_DECL(IN, END, ADAPT, INPUT, SHIFT, SLICE, SLICE8, LOAD16, INDEX16) \
+    for (unsigned int i = 0; i < CRCEA_BITSIZE; i ++) {                     \
+        CRCEA_TYPE s = (design->reflectin ?                                 \
+                        (CRCEA_TYPE)1 << i :                                \
+                        (CRCEA_TYPE)1 << (CRCEA_BITSIZE - 1 - i));          \
+        for (size_t n = CRCEA_INTERLEAVE_LANESIZE; n > 0; n --) {           \
+            s = SHIFT(s, 8) ^ t[SLICE(s, 0, 8)];                            \
+        }                                                                   \
+        col[i] = s;                                                         \
+    }                                                                       \
+                                                                            \
+    for (unsigned int k = 0; k < sizeof(CRCEA_TYPE); k ++) {                \
+        for (unsigned int n = 0; n < 256; n ++) {                           \
+            CRCEA_TYPE r = 0;                                               \
+            for (unsigned int i = 0; i < 8; i ++) {                         \
+                if (SLICE8(n, i, 1)) { r ^= col[k * 8 + i]; }               \
+            }                                                               \
+            shift[k][n] = r;                                                \
+        }                                                                   \
+    }                                                                       \
+
+    CRCEA_UPDATE_SIMPLE_DECL(design, p, pp, state, CRCEA_INTERLEAVE_BUILD_SHIFT_DECL);
+}
+
+/*
+ * Slicing by Octuple Octet with two lanes
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_UPDATE_BY8_OCTET_2WAY(const crcea_design *design, const char *p, const char *pp, CRCEA_TYPE state, const void *table)
+{
+    const CRCEA_TYPE (*t)[256] = (const CRCEA_TYPE (*)[256])table;
+    const CRCEA_TYPE (*shift)[256] = t + 8;
+
+#define CRCEA_INTERLEAVE_STEP8(S, Q, SHIFT, SLICE)                          \
+        S = SHIFT(S, 64) ^                                                  \
+            t[7][(uint8_t)(Q)[0] ^ SLICE(S,  0, 8)] ^                       \
+            t[6][(uint8_t)(Q)[1] ^ SLICE(S,  8, 8)] ^                       \
+            t[5][(uint8_t)(Q)[2] ^ SLICE(S, 16, 8)] ^                       \
+            t[4][(uint8_t)(Q)[3] ^ SLICE(S, 24, 8)] ^                       \
+            t[3][(uint8_t)(Q)[4] ^ SLICE(S, 32, 8)] ^                       \
+            t[2][(uint8_t)(Q)[5] ^ SLICE(S, 40, 8)] ^                       \
+            t[1][(uint8_t)(Q)[6] ^ SLICE(S, 48, 8)] ^                       \
+            t[0][(uint8_t)(Q)[7] ^ SLICE(S, 56, 8)];                        \
+
+#define CRCEA_BY8_OCTET_2WAY_DECL(IN, END, ADAPT, INPUT, SHIFT, SLICE, SLICE8, LOAD16, INDEX16) \
+    while ((size_t)(END - IN) >= 2 * CRCEA_INTERLEAVE_LANESIZE) {           \
+        CRCEA_TYPE s0 = state, s1 = 0;                                      \
+        const char *q = IN;                                                 \
+        const char *const qq = IN + CRCEA_INTERLEAVE_LANESIZE;              \
+        for (; q < qq; q += 8) {                                            \
+            CRCEA_INTERLEAVE_STEP8(s0, q, SHIFT, SLICE);                    \
+            CRCEA_INTERLEAVE_STEP8(s1, q + CRCEA_INTERLEAVE_LANESIZE, SHIFT, SLICE); \
+        }                                                                   \
+                                                                            \
+        state = s1;                                                         \
+        for (unsigned int i = 0; i < sizeof(CRCEA_TYPE); i ++) {            \
+            state ^= shift[i][SLICE(s0, i * 8, 8)];                         \
+        }                                                                   \
+                                                                            \
+        IN += 2 * CRCEA_INTERLEAVE_LANESIZE;                                \
+    }                                                                       \
+                                                                            \
+    CRCEA_UPDATE_STRIPE(IN, END, 8);                                        \
+        CRCEA_INTERLEAVE_STEP8(state, IN, SHIFT, SLICE);                    \
+    CRCEA_UPDATE_BYTE(IN, END);                                             \
+        state = SHIFT(state, 8) ^ t[0][(uint8_t)*IN ^ SLICE(state, 0, 8)];  \
+    CRCEA_UPDATE_END();                                                     \
+
+    CRCEA_UPDATE_DECL(design, p, pp, state, CRCEA_BY8_OCTET_2WAY_DECL);
+
+    return state;
+}
+
+#endif /* CRCEA_ENABLE_BY8_OCTET_2WAY */
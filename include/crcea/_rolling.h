@@ -0,0 +1,87 @@
+/**
+ * @file _rolling.h
+ * @brief 汎用 CRC 生成器
+ * @author dearblue <dearblue@users.osdn.me>
+ * @license Creative Commons Zero License (CC0 / Public Domain)
+ *
+ * Rolling CRC over a sliding window of a fixed number of bytes.
+ *
+ * The state is the CRC of the window computed from the zero state.
+ * Each step takes the incoming byte by the standard table and removes the
+ * outgoing byte by the "out table", which holds the standard table entries
+ * multiplied by x^(8 * window), so the cost per byte does not depend on
+ * the window size.
+ */
+
+/*
+ * CRCEA_TYPE[2][256] のテーブルを構築する。
+ *
+ * t[0] は CRCEA_BY1_OCTET と同じテーブルで、t[1] は t[0] * x^(8 * window) mod P。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE void
+CRCEA_ROLLING_BUILD_TABLE(const crcea_design *design, uint64_t window, void *table)
+{
+    CRCEA_TYPE (*t)[256] = (CRCEA_TYPE (*)[256])table;
+    crcea_gf2_modulus m;
+    const crcea_gf2_modulus *mod = CRCEA_GF2_MODULUS(design, &m);
+
+    CRCEA_BUILD_TABLE(design, CRCEA_BY1_OCTET, t[0]);
+
+    CRCEA_TYPE k = CRCEA_GF2_XPOW8N(design, mod, window);
+    for (int n = 0; n < 256; n ++) {
+        t[1][n] = CRCEA_GF2_MULMOD(design, mod, t[0][n], k);
+    }
+}
+
+/*
+ * 窓の状態から CRC 値を求めるための定数を求める。
+ *
+ * base は crc を初期値として window バイトの 0 を入力した内部状態。
+ * unshift は窓の状態に掛けて crcea_update() の内部状態に揃える値で、
+ * appendzero が偽であれば x^-bitsize mod P となる。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE void
+CRCEA_ROLLING_SETUP(const crcea_design *design, uint64_t window, CRCEA_TYPE crc, CRCEA_TYPE *base, CRCEA_TYPE *unshift)
+{
+    crcea_gf2_modulus m;
+    const crcea_gf2_modulus *mod = CRCEA_GF2_MODULUS(design, &m);
+
+    *base = CRCEA_GF2_MULMOD(design, mod, CRCEA_SETUP(design, crc), CRCEA_GF2_XPOW8N(design, mod, window));
+
+    if (design->appendzero) {
+        *unshift = CRCEA_GF2_ONE(design);
+    } else {
+        *unshift = CRCEA_GF2_INVERSE(design, CRCEA_GF2_XPOW(design, mod, design->bitsize));
+    }
+}
+
+/*
+ * 窓から out を取り除き、in を加える。
+ */
+static inline CRCEA_TYPE
+CRCEA_ROLLING_ROLL(const crcea_design *design, const void *table, CRCEA_TYPE state, uint8_t out, uint8_t in)
+{
+    const CRCEA_TYPE (*t)[256] = (const CRCEA_TYPE (*)[256])table;
+
+#define CRCEA_ROLLING_ROLL_DECL(IN, END, ADAPT, INPUT, SHIFT, SLICE, SLICE8, LOAD16, INDEX16) \
+    state = SHIFT(state, 8) ^ t[0][in ^ SLICE(state, 0, 8)] ^ t[1][out];   \
+
+    CRCEA_UPDATE_SIMPLE_DECL(design, p, pp, state, CRCEA_ROLLING_ROLL_DECL);
+
+    return state;
+}
+
+/*
+ * 窓の状態から窓の CRC 値を求める
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_ROLLING_CRC(const crcea_design *design, CRCEA_TYPE base, CRCEA_TYPE unshift, CRCEA_TYPE state)
+{
+    crcea_gf2_modulus m;
+
+    if (!design->appendzero) {
+        state = CRCEA_GF2_MULMOD(design, CRCEA_GF2_MODULUS(design, &m), state, unshift);
+    }
+
+    return CRCEA_FINISH(design, base ^ state);
+}
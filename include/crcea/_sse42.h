@@ -0,0 +1,183 @@
+/**
+ * @file _sse42.h
+ * @brief 汎用 CRC 生成器
+ * @author dearblue <dearblue@users.osdn.me>
+ * @license Creative Commons Zero License (CC0 / Public Domain)
+ *
+ * CRC-32C (Castagnoli) by the CRC32 instruction of SSE4.2.
+ *
+ * The buffer is split into three streams, and they are merged by the tables
+ * that shift the CRC over a fixed number of zero bytes.
+ * So the CRC32 instruction is not bounded by its latency but its throughput.
+ *
+ * references:
+ * * https://stackoverflow.com/questions/17645167/implementing-sse-4-2s-crc32c-in-software/17646775
+ *      (crc32c.c by Mark Adler)
+ */
+
+#ifdef CRCEA_ENABLE_SSE42_CRC32C
+
+#ifndef CRCEA_SSE42_ONCE__
+#define CRCEA_SSE42_ONCE__ 1
+
+#define CRCEA_SSE42_LONG    8192
+#define CRCEA_SSE42_SHORT   256
+
+typedef struct crcea_sse42_constants
+{
+    uint32_t longshift[4][256];     /* CRCEA_SSE42_LONG バイトの 0 を入力した場合の内部状態 */
+    uint32_t shortshift[4][256];    /* CRCEA_SSE42_SHORT バイトの 0 を入力した場合の内部状態 */
+} crcea_sse42_constants;
+
+/*
+ * reflectin であるビット長 32 の CRC の内部状態を len バイトの 0 の入力で進めるテーブル
+ */
+static void
+crcea_sse42_build_shift(uint32_t shift[4][256], uint32_t poly, size_t len)
+{
+    uint32_t col[32];
+    uint32_t s = 0x80000000ul;  /* x^0 */
+
+    for (size_t i = len * 8; i > 0; i --) {
+        s = (s >> 1) ^ (poly & -(s & 1));
+    }
+
+    for (int i = 31; i >= 0; i --) {
+        col[i] = s;
+        s = (s >> 1) ^ (poly & -(s & 1));
+    }
+
+    for (int n = 0; n < 4; n ++) {
+        for (int b = 0; b < 256; b ++) {
+            uint32_t r = 0;
+            for (int i = 0; i < 8; i ++) {
+                r ^= col[n * 8 + i] & -(uint32_t)((b >> i) & 1);
+            }
+            shift[n][b] = r;
+        }
+    }
+}
+
+static void
+crcea_sse42_build_constants(const crcea_design *design, void *table)
+{
+    crcea_sse42_constants *k = (crcea_sse42_constants *)table;
+    uint32_t poly = 0;
+
+    if (design->bitsize == 32) {
+        for (int i = 0; i < 32; i ++) {
+            poly |= (uint32_t)((design->polynomial >> i) & 1) << (31 - i);
+        }
+    }
+
+    crcea_sse42_build_shift(k->longshift, poly, CRCEA_SSE42_LONG);
+    crcea_sse42_build_shift(k->shortshift, poly, CRCEA_SSE42_SHORT);
+}
+
+static int
+crcea_sse42_is_castagnoli(const crcea_design *design)
+{
+    return design->bitsize == 32 && design->reflectin &&
+           (uint32_t)design->polynomial == 0x1edc6f41ul;
+}
+
+#ifdef CRCEA_X86_64_SIMD
+
+#include <string.h>
+#include <immintrin.h>
+
+#define CRCEA_SSE42_TARGET __attribute__((target("sse4.2")))
+
+static inline uint32_t
+crcea_sse42_shift(const uint32_t shift[4][256], uint32_t crc)
+{
+    return shift[0][crc & 0xff] ^ shift[1][(crc >> 8) & 0xff] ^
+           shift[2][(crc >> 16) & 0xff] ^ shift[3][crc >> 24];
+}
+
+static inline uint64_t
+crcea_sse42_load64(const char *p)
+{
+    uint64_t n;
+    memcpy(&n, p, sizeof(n));
+    return n;
+}
+
+static CRCEA_SSE42_TARGET uint32_t
+crcea_sse42_crc32c(const crcea_sse42_constants *k, const char *p, const char *pp, uint32_t state)
+{
+    uint64_t s0 = state;
+
+    for (; ((uintptr_t)p & 7) != 0 && p < pp; p ++) {
+        s0 = _mm_crc32_u8((uint32_t)s0, (uint8_t)*p);
+    }
+
+#define CRCEA_SSE42_3WAY(SIZE, SHIFT)                                       \
+    while ((size_t)(pp - p) >= (SIZE) * 3) {                                \
+        uint64_t s1 = 0, s2 = 0;                                            \
+        const char *const stop__ = p + (SIZE);                              \
+        for (; p < stop__; p += 8) {                                        \
+            s0 = _mm_crc32_u64(s0, crcea_sse42_load64(p));                  \
+            s1 = _mm_crc32_u64(s1, crcea_sse42_load64(p + (SIZE)));         \
+            s2 = _mm_crc32_u64(s2, crcea_sse42_load64(p + (SIZE) * 2));     \
+        }                                                                   \
+        s0 = crcea_sse42_shift(SHIFT, (uint32_t)s0) ^ s1;                   \
+        s0 = crcea_sse42_shift(SHIFT, (uint32_t)s0) ^ s2;                   \
+        p += (SIZE) * 2;                                                    \
+    }                                                                       \
+
+    CRCEA_SSE42_3WAY(CRCEA_SSE42_LONG, k->longshift);
+    CRCEA_SSE42_3WAY(CRCEA_SSE42_SHORT, k->shortshift);
+
+#undef CRCEA_SSE42_3WAY
+
+    for (; (size_t)(pp - p) >= 8; p += 8) {
+        s0 = _mm_crc32_u64(s0, crcea_sse42_load64(p));
+    }
+
+    for (; p < pp; p ++) {
+        s0 = _mm_crc32_u8((uint32_t)s0, (uint8_t)*p);
+    }
+
+    return (uint32_t)s0;
+}
+
+static int
+crcea_sse42_available(void)
+{
+    return crcea_cpu_supports(CRCEA_CPU_SSE42);
+}
+
+#endif /* CRCEA_X86_64_SIMD */
+
+#endif /* CRCEA_SSE42_ONCE__ */
+
+/*
+ * CRC-32C by SSE4.2 with three streams
+ *
+ * Other designs than CRC-32C (or hosts without SSE4.2) are done by the standard table.
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_UPDATE_SSE42_CRC32C(const crcea_design *design, const char *p, const char *pp, CRCEA_TYPE state, const void *table)
+{
+    const CRCEA_TYPE *t = (const CRCEA_TYPE *)((const char *)table + sizeof(crcea_sse42_constants));
+
+#ifdef CRCEA_X86_64_SIMD
+    if (CRCEA_BITSIZE >= 32 && crcea_sse42_is_castagnoli(design) && crcea_sse42_available()) {
+        return (CRCEA_TYPE)crcea_sse42_crc32c((const crcea_sse42_constants *)table, p, pp, (uint32_t)state);
+    }
+#endif
+
+#define CRCEA_SSE42_CRC32C_DECL(IN, END, ADAPT, INPUT, SHIFT, SLICE, SLICE8, LOAD16, INDEX16) \
+    CRCEA_UPDATE_STRIPE(IN, END, 1);                                        \
+        state = SHIFT(state, 8) ^ t[(uint8_t)*IN ^ SLICE(state, 0, 8)];     \
+    CRCEA_UPDATE_BYTE(IN, END);                                             \
+        state = SHIFT(state, 8) ^ t[(uint8_t)*IN ^ SLICE(state, 0, 8)];     \
+    CRCEA_UPDATE_END();                                                     \
+
+    CRCEA_UPDATE_DECL(design, p, pp, state, CRCEA_SSE42_CRC32C_DECL);
+
+    return state;
+}
+
+#endif /* CRCEA_ENABLE_SSE42_CRC32C */
@@ -68,12 +68,25 @@ CRCEA_TABLESIZE(int algo)
     case CRCEA_BY16_OCTET:
     case CRCEA_BY32_OCTET:
         return sizeof(CRCEA_TYPE[1 * (1 << (algo & 0xff) >> 1)][256]);
+    case CRCEA_BY8_OCTET_2WAY:
+        return sizeof(CRCEA_TYPE[8][256]) + sizeof(CRCEA_TYPE[sizeof(CRCEA_TYPE)][256]);
     case CRCEA_BY2_SEXDECTET:
     case CRCEA_BY4_SEXDECTET:
     case CRCEA_BY8_SEXDECTET:
     case CRCEA_BY16_SEXDECTET:
     case CRCEA_BY32_SEXDECTET:
         return sizeof(CRCEA_TYPE[1 * (1 << (algo & 0xff) >> 2)][65536]);
+#ifdef CRCEA_ENABLE_CLMUL_FOLD
+    case CRCEA_CLMUL_FOLD:
+# ifdef CRCEA_ENABLE_VPCLMUL_FOLD
+    case CRCEA_VPCLMUL_FOLD:
+# endif
+        return sizeof(crcea_clmul_constants) + sizeof(CRCEA_TYPE[256]);
+#endif
+#ifdef CRCEA_ENABLE_SSE42_CRC32C
+    case CRCEA_SSE42_CRC32C:
+        return sizeof(crcea_sse42_constants) + sizeof(CRCEA_TYPE[256]);
+#endif
     default:
         return 0;
     }
@@ -123,6 +136,10 @@ CRCEA_BUILD_TABLE(const crcea_design *design, int algorithm, void *table)
         round = (1 << (algorithm & 0xff) >> 1);
         bits = 8;
         break;
+    case CRCEA_BY8_OCTET_2WAY:
+        round = 8;
+        bits = 8;
+        break;
     case CRCEA_BY2_SEXDECTET:
     case CRCEA_BY4_SEXDECTET:
     case CRCEA_BY8_SEXDECTET:
@@ -131,6 +148,25 @@ CRCEA_BUILD_TABLE(const crcea_design *design, int algorithm, void *table)
         round = (1 << (algorithm & 0xff) >> 2);
         bits = 16;
         break;
+#ifdef CRCEA_ENABLE_CLMUL_FOLD
+    case CRCEA_CLMUL_FOLD:
+# ifdef CRCEA_ENABLE_VPCLMUL_FOLD
+    case CRCEA_VPCLMUL_FOLD:
+# endif
+        CRCEA_CLMUL_BUILD_CONSTANTS(design, table);
+        table = (char *)table + sizeof(crcea_clmul_constants);
+        round = 1;
+        bits = 8;
+        break;
+#endif
+#ifdef CRCEA_ENABLE_SSE42_CRC32C
+    case CRCEA_SSE42_CRC32C:
+        crcea_sse42_build_constants(design, table);
+        table = (char *)table + sizeof(crcea_sse42_constants);
+        round = 1;
+        bits = 8;
+        break;
+#endif
     default:
         return;
     }
@@ -158,4 +194,10 @@ CRCEA_BUILD_TABLE(const crcea_design *design, int algorithm, void *table)
     }                                                                       \
 
     CRCEA_BUILD_TABLE_DEFINE(bits, design, CRCEA_BUILD_TABLE_DECL);
+
+#ifdef CRCEA_ENABLE_BY8_OCTET_2WAY
+    if (algorithm == CRCEA_BY8_OCTET_2WAY) {
+        CRCEA_INTERLEAVE_BUILD_SHIFT(design, table);
+    }
+#endif
 }
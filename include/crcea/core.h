@@ -30,6 +30,10 @@
  * [CRCEA_TYPE]
  *      REQUIRED
  *
+ *      One of uint8_t, uint16_t, uint32_t, uint64_t or crcea_uint128.
+ *      crcea_uint128 needs CRCEA_ENABLE_INT128 for the designs wider than 64 bits,
+ *      and its SIMD algorithms are done by their tables.
+ *
  *      This definision is undefined in last of this file.
  *
  * [CRCEA_STRIPE_SIZE]
@@ -132,6 +136,7 @@
 #endif
 
 #include "defs.h"
+#include "cpu.h"
 
 #ifndef CHAR_BIT
 # include <limits.h>
@@ -151,6 +156,14 @@
 #  include <stdlib.h>
 #  define CRCEA_MALLOC malloc
 # endif
+# ifndef CRCEA_FREE
+#  include <stdlib.h>
+#  define CRCEA_FREE free
+# endif
+#endif
+
+#ifndef CRCEA_UPDATEV_CARRY
+# define CRCEA_UPDATEV_CARRY 8
 #endif
 
 #ifndef CRCEA_STRIPE_SIZE
@@ -164,11 +177,36 @@
 #define CRCEA_SETUP                     CRCEA_TOKEN(_setup)
 #define CRCEA_FINISH                    CRCEA_TOKEN(_finish)
 #define CRCEA_UPDATE                    CRCEA_TOKEN(_update)
+#define CRCEA_SELECT_ALGORITHM          CRCEA_TOKEN(_select_algorithm)
 #define CRCEA_PREPARE_TABLE             CRCEA_TOKEN(_prepare_table)
 #define CRCEA_TABLESIZE                 CRCEA_TOKEN(_tablesize)
 #define CRCEA_BUILD_TABLE               CRCEA_TOKEN(_build_table)
 #define CRCEA_INPUT_TO_STATE            CRCEA_TOKEN(_input_to_state)
 #define CRCEA_UPDATE_SHIFT              CRCEA_TOKEN(_update_shift)
+#define CRCEA_SHIFT_STATE               CRCEA_TOKEN(_shift_state)
+#define CRCEA_GF2_ONE                   CRCEA_TOKEN(_gf2_one)
+#define CRCEA_GF2_MODULUS               CRCEA_TOKEN(_gf2_modulus)
+#define CRCEA_GF2_MULMOD                CRCEA_TOKEN(_gf2_mulmod)
+#define CRCEA_GF2_SQUARE                CRCEA_TOKEN(_gf2_square)
+#define CRCEA_GF2_MULX                  CRCEA_TOKEN(_gf2_mulx)
+#define CRCEA_GF2_XPOW                  CRCEA_TOKEN(_gf2_xpow)
+#define CRCEA_GF2_XPOW8N                CRCEA_TOKEN(_gf2_xpow8n)
+#define CRCEA_GF2_INVERSE               CRCEA_TOKEN(_gf2_inverse)
+#define CRCEA_COMBINE                   CRCEA_TOKEN(_combine)
+#define CRCEA_UPDATE_ZEROS              CRCEA_TOKEN(_update_zeros)
+#define CRCEA_UPDATEV                   CRCEA_TOKEN(_updatev)
+#define CRCEA_UPDATE_BITS               CRCEA_TOKEN(_update_bits)
+#define CRCEA_PATCH                     CRCEA_TOKEN(_patch)
+#define CRCEA_UNUPDATE                  CRCEA_TOKEN(_unupdate)
+#define CRCEA_UPDATE_REPEAT             CRCEA_TOKEN(_update_repeat)
+#define CRCEA_ROLLING_BUILD_TABLE       CRCEA_TOKEN(_rolling_build_table)
+#define CRCEA_ROLLING_SETUP             CRCEA_TOKEN(_rolling_setup)
+#define CRCEA_ROLLING_ROLL              CRCEA_TOKEN(_rolling_roll)
+#define CRCEA_ROLLING_CRC               CRCEA_TOKEN(_rolling_crc)
+#define CRCEA_COMPILED_SETUP            CRCEA_TOKEN(_compiled_setup)
+#define CRCEA_COMPILED_UPDATE           CRCEA_TOKEN(_compiled_update)
+#define CRCEA_COMPILED_FINISH           CRCEA_TOKEN(_compiled_finish)
+#define CRCEA_COMPILE_UPDATE            CRCEA_TOKEN(_compile_update)
 #define CRCEA_UPDATE_UNIFIED            CRCEA_TOKEN(_update_unified)
 #define CRCEA_UPDATE_REFERENCE          CRCEA_TOKEN(_update_reference)
 #define CRCEA_UPDATE_BITWISE_CONDXOR    CRCEA_TOKEN(_update_bitwise_condxor)
@@ -201,17 +239,24 @@
 #define CRCEA_UPDATE_BY8_QUARTET        CRCEA_TOKEN(_update_by8_quartet)
 #define CRCEA_UPDATE_BY16_QUARTET       CRCEA_TOKEN(_update_by16_quartet)
 #define CRCEA_UPDATE_BY32_QUARTET       CRCEA_TOKEN(_update_by32_quartet)
+#define CRCEA_UPDATE_OCTET_WORDS        CRCEA_TOKEN(_update_octet_words)
 #define CRCEA_UPDATE_BY1_OCTET          CRCEA_TOKEN(_update_by1_octet)
 #define CRCEA_UPDATE_BY2_OCTET          CRCEA_TOKEN(_update_by2_octet)
 #define CRCEA_UPDATE_BY4_OCTET          CRCEA_TOKEN(_update_by4_octet)
 #define CRCEA_UPDATE_BY8_OCTET          CRCEA_TOKEN(_update_by8_octet)
 #define CRCEA_UPDATE_BY16_OCTET         CRCEA_TOKEN(_update_by16_octet)
 #define CRCEA_UPDATE_BY32_OCTET         CRCEA_TOKEN(_update_by32_octet)
+#define CRCEA_UPDATE_BY8_OCTET_2WAY     CRCEA_TOKEN(_update_by8_octet_2way)
+#define CRCEA_INTERLEAVE_BUILD_SHIFT    CRCEA_TOKEN(_interleave_build_shift)
 #define CRCEA_UPDATE_BY2_SEXDECTET      CRCEA_TOKEN(_update_by2_sexdectet)
 #define CRCEA_UPDATE_BY4_SEXDECTET      CRCEA_TOKEN(_update_by4_sexdectet)
 #define CRCEA_UPDATE_BY8_SEXDECTET      CRCEA_TOKEN(_update_by8_sexdectet)
 #define CRCEA_UPDATE_BY16_SEXDECTET     CRCEA_TOKEN(_update_by16_sexdectet)
 #define CRCEA_UPDATE_BY32_SEXDECTET     CRCEA_TOKEN(_update_by32_sexdectet)
+#define CRCEA_UPDATE_CLMUL_FOLD         CRCEA_TOKEN(_update_clmul_fold)
+#define CRCEA_CLMUL_BUILD_CONSTANTS     CRCEA_TOKEN(_clmul_build_constants)
+#define CRCEA_UPDATE_VPCLMUL_FOLD       CRCEA_TOKEN(_update_vpclmul_fold)
+#define CRCEA_UPDATE_SSE42_CRC32C       CRCEA_TOKEN(_update_sse42_crc32c)
 
 #define CRCEA_BITSIZE                   (sizeof(CRCEA_TYPE) * CHAR_BIT)
 #define CRCEA_LSH(N, OFF)               ((OFF) < CRCEA_BITSIZE ? (N) << (OFF) : 0)
@@ -242,13 +287,27 @@ CRCEA_BITREFLECT(CRCEA_TYPE n)
         n = ((n >>  4) & 0x0f0f0f0ful) | ((n & 0x0f0f0f0ful) <<  4);
         n = ((n >>  2) & 0x33333333ul) | ((n & 0x33333333ul) <<  2);
         n = ((n >>  1) & 0x55555555ul) | ((n & 0x55555555ul) <<  1);
-    } else { /* if (sizeof(CRCEA_TYPE) <= 8) { */
+    } else if (sizeof(CRCEA_TYPE) <= 8) {
         n = ((n >> 32) & 0x00000000ffffffffull) | ( n                          << 32);
         n = ((n >> 16) & 0x0000ffff0000ffffull) | ((n & 0x0000ffff0000ffffull) << 16);
         n = ((n >>  8) & 0x00ff00ff00ff00ffull) | ((n & 0x00ff00ff00ff00ffull) <<  8);
         n = ((n >>  4) & 0x0f0f0f0f0f0f0f0full) | ((n & 0x0f0f0f0f0f0f0f0full) <<  4);
         n = ((n >>  2) & 0x3333333333333333ull) | ((n & 0x3333333333333333ull) <<  2);
         n = ((n >>  1) & 0x5555555555555555ull) | ((n & 0x5555555555555555ull) <<  1);
+    } else { /* if (sizeof(CRCEA_TYPE) <= 16) { */
+        /* 上位と下位の 64 ビットをそれぞれ反転して入れ替える */
+        uint64_t h[2] = { (uint64_t)n, (uint64_t)CRCEA_RSH(n, 64) };
+        for (int i = 0; i < 2; i ++) {
+            uint64_t m = h[i];
+            m = ((m >> 32) & 0x00000000ffffffffull) | ( m                          << 32);
+            m = ((m >> 16) & 0x0000ffff0000ffffull) | ((m & 0x0000ffff0000ffffull) << 16);
+            m = ((m >>  8) & 0x00ff00ff00ff00ffull) | ((m & 0x00ff00ff00ff00ffull) <<  8);
+            m = ((m >>  4) & 0x0f0f0f0f0f0f0f0full) | ((m & 0x0f0f0f0f0f0f0f0full) <<  4);
+            m = ((m >>  2) & 0x3333333333333333ull) | ((m & 0x3333333333333333ull) <<  2);
+            m = ((m >>  1) & 0x5555555555555555ull) | ((m & 0x5555555555555555ull) <<  1);
+            h[i] = m;
+        }
+        n = CRCEA_LSH((CRCEA_TYPE)h[0], 64) | h[1];
     }
     return n;
 }
@@ -353,8 +412,13 @@ CRCEA_FINISH(const crcea_design *design, CRCEA_TYPE state)
 #include "_by_duo.h"
 #include "_by_quartet.h"
 #include "_by_octet.h"
+#include "_interleave.h"
 #include "_by_sexdectet.h"
+#include "_gf2.h"
+#include "_clmul.h"
+#include "_sse42.h"
 #include "_table.h"
+#include "_rolling.h"
 
 /*
  * 入力を伴わないガロア体の除算
@@ -587,6 +651,11 @@ CRCEA_UPDATE_UNIFIED(const crcea_design *design, const char *p, const char *pp,
         return CRCEA_UPDATE_BY32_OCTET(design, p, pp, state, table);
 #endif
 
+#ifdef CRCEA_ENABLE_BY8_OCTET_2WAY
+    case CRCEA_BY8_OCTET_2WAY:
+        return CRCEA_UPDATE_BY8_OCTET_2WAY(design, p, pp, state, table);
+#endif
+
 #ifdef CRCEA_ENABLE_BY2_SEXDECTET
     case CRCEA_BY2_SEXDECTET:
         return CRCEA_UPDATE_BY2_SEXDECTET(design, p, pp, state, table);
@@ -612,12 +681,72 @@ CRCEA_UPDATE_UNIFIED(const crcea_design *design, const char *p, const char *pp,
         return CRCEA_UPDATE_BY32_SEXDECTET(design, p, pp, state, table);
 #endif
 
+#ifdef CRCEA_ENABLE_CLMUL_FOLD
+    case CRCEA_CLMUL_FOLD:
+        return CRCEA_UPDATE_CLMUL_FOLD(design, p, pp, state, table);
+#endif
+
+#ifdef CRCEA_ENABLE_VPCLMUL_FOLD
+    case CRCEA_VPCLMUL_FOLD:
+        return CRCEA_UPDATE_VPCLMUL_FOLD(design, p, pp, state, table);
+#endif
+
+#ifdef CRCEA_ENABLE_SSE42_CRC32C
+    case CRCEA_SSE42_CRC32C:
+        return CRCEA_UPDATE_SSE42_CRC32C(design, p, pp, state, table);
+#endif
+
     case CRCEA_FALLBACK:
     default:
         return CRCEA_UPDATE_FALLBACK(design, p, pp, state);
     }
 }
 
+/*
+ * 入力を伴わないガロア体の除算を、選択されたアルゴリズムで bits ビットの 0 を入力することで行う。
+ *
+ * 8 ビット未満の端数は、内部状態からあふれる端数のビットを 1 バイトの入力として 0 の内部状態から処理し、
+ * 端数だけずらした内部状態に重ねるため、1 ビットずつの処理は行わない。
+ * CRCEA_UPDATE からは bitsize ビット以下のずらしにだけ使われ、選択されたアルゴリズムの呼び出しは 2 回以下となる。
+ */
+static inline CRCEA_TYPE
+CRCEA_SHIFT_STATE(const crcea_design *design, size_t bits, CRCEA_TYPE state, int algo, const void *table)
+{
+    static const char zero[16] = { 0 };
+
+    for (; bits >= sizeof(zero) * 8; bits -= sizeof(zero) * 8) {
+        state = CRCEA_UPDATE_UNIFIED(design, zero, zero + sizeof(zero), state, algo, table);
+    }
+
+    if (bits >= 8) {
+        state = CRCEA_UPDATE_UNIFIED(design, zero, zero + bits / 8, state, algo, table);
+    }
+
+    if (bits % 8 > 0) {
+        const unsigned int rest = bits % 8;
+        char ch;
+
+        if (design->reflectin) {
+            ch = (char)(CRCEA_SLICE_R(state, 0, rest) << (8 - rest));
+            state = CRCEA_RSH(state, rest);
+        } else {
+            ch = (char)CRCEA_SLICE(state, 0, rest);
+            state = CRCEA_LSH(state, rest);
+        }
+
+        state ^= CRCEA_UPDATE_UNIFIED(design, &ch, &ch + 1, 0, algo, table);
+    }
+
+    return state;
+}
+
+/*
+ * appendzero が偽であれば、内部状態は入力値そのものの P による剰余 (M mod P) となる。
+ *
+ * テーブルによるアルゴリズムは入力値に x^bitsize を掛けた剰余を求めるため、
+ * 先に内部状態を bitsize ビット進めておき、末尾の (bitsize + 7) / 8 バイトは除算せずに充填する。
+ * 呼び出しの前後で内部状態の意味は変わらないため、入力を任意の位置で分割して呼び出してよい。
+ */
 CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
 CRCEA_UPDATE(const crcea_design *design, const char *p, const char *pp, CRCEA_TYPE state, int algo, const void *table)
 {
@@ -638,17 +767,17 @@ CRCEA_UPDATE(const crcea_design *design, const char *p, const char *pp, CRCEA_TY
                 state = CRCEA_INPUT_TO_STATE(design, 0, p, pp, state);
                 state = CRCEA_UPDATE_SHIFT(design, 8 - design->bitsize, state);
             } else {
-                state = CRCEA_UPDATE_SHIFT(design, (pp - p) * 8, state);
+                state = CRCEA_SHIFT_STATE(design, (pp - p) * 8, state, algo, table);
                 state = CRCEA_INPUT_TO_STATE(design, design->bitsize - (pp - p) * 8, p, pp, state);
             }
         } else {
             const char *stop__ = (const char *)pp - (design->bitsize + 7) / 8;
 
-            state = CRCEA_UPDATE_SHIFT(design, design->bitsize, state);
+            state = CRCEA_SHIFT_STATE(design, design->bitsize, state, algo, table);
             state = CRCEA_UPDATE_UNIFIED(design, p, stop__, state, algo, table);
             state = CRCEA_INPUT_TO_STATE(design, 0, stop__, pp, state);
             if (design->bitsize % 8 > 0) {
-                state = CRCEA_UPDATE_SHIFT(design, 8 - design->bitsize % 8, state);
+                state = CRCEA_SHIFT_STATE(design, 8 - design->bitsize % 8, state, algo, table);
             }
         }
 
@@ -656,6 +785,273 @@ CRCEA_UPDATE(const crcea_design *design, const char *p, const char *pp, CRCEA_TY
     }
 }
 
+/*
+ * p から nbits ビットの入力を処理する。
+ *
+ * 8 ビットに満たない末尾の端数は、reflectin が真であれば最後のバイトの下位ビットから、
+ * 偽であれば上位ビットから取り出される。
+ * 端数の前までは選択されたアルゴリズムで処理し、端数だけを 1 ビットずつ処理する。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_UPDATE_BITS(const crcea_design *design, const char *p, size_t nbits, CRCEA_TYPE state, int algo, const void *table)
+{
+    const char *const pp = p + nbits / 8;
+    const int rest = nbits % 8;
+
+    state = CRCEA_UPDATE(design, p, pp, state, algo, table);
+
+    if (rest == 0) { return state; }
+
+    const uint8_t ch = *(const uint8_t *)pp;
+
+    if (design->appendzero) {
+        if (design->reflectin) {
+            state ^= CRCEA_INPUT_R(ch & (0xff >> (8 - rest)));
+        } else {
+            state ^= CRCEA_INPUT(ch & (0xff00 >> rest));
+        }
+
+        state = CRCEA_UPDATE_SHIFT(design, rest, state);
+    } else {
+        const CRCEA_TYPE one = CRCEA_GF2_ONE(design);
+
+        for (int i = 0; i < rest; i ++) {
+            int bit = (design->reflectin ? ch >> i : ch >> (7 - i)) & 1;
+            state = CRCEA_UPDATE_SHIFT(design, 1, state);
+            if (bit) { state ^= one; }
+        }
+    }
+
+    return state;
+}
+
+/*
+ * iovcnt 個の領域を連結した入力を処理する。
+ *
+ * appendzero が真であるテーブルによるアルゴリズムでは、領域の境界にまたがる端数を
+ * CRCEA_UPDATEV_CARRY バイトの一時領域に集めてから処理するため、1 バイトずつの処理は最後の端数だけになる。
+ * SIMD 命令によるアルゴリズムは長い入力ほど速いため、領域を分割せずにそのまま与える。
+ * appendzero が偽であれば領域ごとに CRCEA_UPDATE を呼ぶ。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_UPDATEV(const crcea_design *design, const crcea_iovec *iov, size_t iovcnt, CRCEA_TYPE state, int algo, const void *table)
+{
+    int direct = !design->appendzero;
+
+#ifdef CRCEA_ENABLE_REFERENCE
+    direct = direct || algo == CRCEA_REFERENCE;
+#endif
+
+    if (direct) {
+        for (; iovcnt > 0; iov ++, iovcnt --) {
+            const char *p = (const char *)iov->base;
+            state = CRCEA_UPDATE(design, p, p + iov->len, state, algo, table);
+        }
+
+        return state;
+    }
+
+    if (algo >= CRCEA_CLMUL_GROUP && algo < CRCEA_INTERLEAVE_GROUP) {
+        for (; iovcnt > 0; iov ++, iovcnt --) {
+            const char *p = (const char *)iov->base;
+            state = CRCEA_UPDATE_UNIFIED(design, p, p + iov->len, state, algo, table);
+        }
+
+        return state;
+    }
+
+    char carry[CRCEA_UPDATEV_CARRY];
+    size_t held = 0;
+
+    for (; iovcnt > 0; iov ++, iovcnt --) {
+        const char *p = (const char *)iov->base;
+        const char *const pp = p + iov->len;
+
+        if (held > 0) {
+            for (; held < sizeof(carry) && p < pp; held ++, p ++) {
+                carry[held] = *p;
+            }
+
+            if (held < sizeof(carry)) {
+                continue;
+            }
+
+            state = CRCEA_UPDATE_UNIFIED(design, carry, carry + sizeof(carry), state, algo, table);
+            held = 0;
+        }
+
+        size_t bulk = (size_t)(pp - p) / sizeof(carry) * sizeof(carry);
+        if (bulk > 0) {
+            state = CRCEA_UPDATE_UNIFIED(design, p, p + bulk, state, algo, table);
+            p += bulk;
+        }
+
+        for (; p < pp; held ++, p ++) {
+            carry[held] = *p;
+        }
+    }
+
+    if (held > 0) {
+        state = CRCEA_UPDATE_UNIFIED(design, carry, carry + held, state, algo, table);
+    }
+
+    return state;
+}
+
+/*
+ * crca を CRC 値とする入力に、crcb を CRC 値とする lenb バイトの入力を連結した場合の CRC 値を求める。
+ *
+ * crcb は直前の CRC 値を 0 として計算されたものであること。
+ * 入力を読み直さずに O(log lenb) で求められる。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_COMBINE(const crcea_design *design, CRCEA_TYPE crca, CRCEA_TYPE crcb, uint64_t lenb)
+{
+    crcea_gf2_modulus m;
+    const crcea_gf2_modulus *mod = CRCEA_GF2_MODULUS(design, &m);
+    CRCEA_TYPE s = CRCEA_SETUP(design, crca) ^ CRCEA_SETUP(design, 0);
+
+    s = CRCEA_GF2_MULMOD(design, mod, s, CRCEA_GF2_XPOW8N(design, mod, lenb));
+
+    return CRCEA_FINISH(design, s ^ CRCEA_SETUP(design, crcb));
+}
+
+/*
+ * n バイトの 0 を入力した場合の内部状態を求める。
+ *
+ * 入力を読まずに O(log n) で求められる。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_UPDATE_ZEROS(const crcea_design *design, uint64_t n, CRCEA_TYPE state)
+{
+    if (n == 0) { return state; }
+
+    crcea_gf2_modulus m;
+    const crcea_gf2_modulus *mod = CRCEA_GF2_MODULUS(design, &m);
+
+    return CRCEA_GF2_MULMOD(design, mod, state, CRCEA_GF2_XPOW8N(design, mod, n));
+}
+
+/*
+ * p から pp までのバイト列を times 回繰り返して入力した場合の内部状態を求める。
+ *
+ * X = x^(8 * n) として state * X^times + u * (X^(times - 1) + ... + X + 1) となる。
+ * u はバイト列を 0 の状態から処理した値。
+ * 二乗を繰り返して求めるため、繰り返しのバッファは不要で O(n + log times) で求められる。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_UPDATE_REPEAT(const crcea_design *design, const char *p, const char *pp, uint64_t times, CRCEA_TYPE state, int algo, const void *table)
+{
+    if (p >= pp || times == 0) { return state; }
+
+    crcea_gf2_modulus m;
+    const crcea_gf2_modulus *mod = CRCEA_GF2_MODULUS(design, &m);
+    const CRCEA_TYPE one = CRCEA_GF2_ONE(design);
+    const CRCEA_TYPE x = CRCEA_GF2_XPOW8N(design, mod, (uint64_t)(pp - p));
+    CRCEA_TYPE a = one, b = 0;  /* X^i, X^(i - 1) + ... + 1 */
+    int i;
+
+    for (i = 63; ((times >> i) & 1) == 0; i --) { }
+
+    for (; i >= 0; i --) {
+        b = CRCEA_GF2_MULMOD(design, mod, b, a ^ one);
+        a = CRCEA_GF2_SQUARE(design, mod, a);
+        if ((times >> i) & 1) {
+            b = CRCEA_GF2_MULMOD(design, mod, b, x) ^ one;
+            a = CRCEA_GF2_MULMOD(design, mod, a, x);
+        }
+    }
+
+    CRCEA_TYPE u = CRCEA_UPDATE(design, p, pp, 0, algo, table);
+
+    return CRCEA_GF2_MULMOD(design, mod, state, a) ^ CRCEA_GF2_MULMOD(design, mod, u, b);
+}
+
+/*
+ * CRC 値が crc である total バイトの入力の offset バイト目からの n バイトが
+ * oldbytes から newbytes に書き換えられた場合の CRC 値を求める。
+ *
+ * 書き換えの差分だけを処理して残りの長さ分を O(log total) でずらすため、
+ * 入力全体を読み直す必要はない。offset + n は total 以下であること。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_PATCH(const crcea_design *design, CRCEA_TYPE crc, uint64_t total, uint64_t offset, const char *oldbytes, const char *newbytes, size_t n, int algo, const void *table)
+{
+    CRCEA_TYPE s = 0;
+    char diff[256];
+
+    for (size_t off = 0; off < n; off += sizeof(diff)) {
+        size_t len = (n - off < sizeof(diff) ? n - off : sizeof(diff));
+        for (size_t i = 0; i < len; i ++) {
+            diff[i] = oldbytes[off + i] ^ newbytes[off + i];
+        }
+
+        s = CRCEA_UPDATE(design, diff, diff + len, s, algo, table);
+    }
+
+    s = CRCEA_UPDATE_ZEROS(design, total - offset - n, s);
+
+    return CRCEA_FINISH(design, CRCEA_SETUP(design, crc) ^ s);
+}
+
+/*
+ * 内部状態 state から、最後に入力された p から pp までのバイト列を取り除く。
+ *
+ * 取り除くバイト列を 0 の状態から処理した値を打ち消し、x^(8 * n) の逆元を掛けて戻す。
+ * 生成多項式の定数項が 0 であれば戻せないため、0 を返す。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE CRCEA_TYPE
+CRCEA_UNUPDATE(const crcea_design *design, const char *p, const char *pp, CRCEA_TYPE state, int algo, const void *table)
+{
+    if (p >= pp) { return state; }
+
+    crcea_gf2_modulus m;
+    const crcea_gf2_modulus *mod = CRCEA_GF2_MODULUS(design, &m);
+    CRCEA_TYPE inv = CRCEA_GF2_INVERSE(design, CRCEA_GF2_XPOW8N(design, mod, (uint64_t)(pp - p)));
+
+    state ^= CRCEA_UPDATE(design, p, pp, 0, algo, table);
+
+    return CRCEA_GF2_MULMOD(design, mod, state, inv);
+}
+
+/*
+ * CRCEA_AUTOMATIC を実行中の CPU と design に対して最適と思われるアルゴリズムに置き換える。
+ *
+ * 有効化されていないアルゴリズムは選ばれない。
+ * いずれの命令も利用できなければ CRCEA_DEFAULT_ALGORITHM を返す。
+ */
+CRCEA_VISIBILITY CRCEA_INLINE int
+CRCEA_SELECT_ALGORITHM(const crcea_design *design, int algo)
+{
+    if (algo != CRCEA_AUTOMATIC) {
+        return algo;
+    }
+
+    (void)design;
+
+#if defined(CRCEA_ENABLE_SSE42_CRC32C) && defined(CRCEA_X86_64_SIMD)
+    if (CRCEA_BITSIZE >= 32 && crcea_sse42_is_castagnoli(design) && crcea_sse42_available()) {
+        return CRCEA_SSE42_CRC32C;
+    }
+#endif
+
+#if defined(CRCEA_ENABLE_VPCLMUL_FOLD) && defined(CRCEA_X86_64_SIMD)
+    if (CRCEA_BITSIZE <= 64 && crcea_vpclmul_available()) {
+        return CRCEA_VPCLMUL_FOLD;
+    }
+#endif
+
+#if defined(CRCEA_ENABLE_CLMUL_FOLD) && defined(CRCEA_X86_64_SIMD)
+    if (CRCEA_BITSIZE <= 64 && crcea_clmul_available()) {
+        return CRCEA_CLMUL_FOLD;
+    }
+#endif
+
+    return CRCEA_DEFAULT_ALGORITHM;
+}
+
+#include "_compile.h"
+
 CRCEA_END_C_DECL
 
 
@@ -673,6 +1069,7 @@ CRCEA_END_C_DECL
 #undef CRCEA_SETUP
 #undef CRCEA_FINISH
 #undef CRCEA_UPDATE
+#undef CRCEA_SELECT_ALGORITHM
 #undef CRCEA_PREPARE_TABLE
 #undef CRCEA_TABLESIZE
 #undef CRCEA_BUILD_TABLE
@@ -707,17 +1104,25 @@ CRCEA_END_C_DECL
 #undef CRCEA_UPDATE_BY8_QUARTET
 #undef CRCEA_UPDATE_BY16_QUARTET
 #undef CRCEA_UPDATE_BY32_QUARTET
+#undef CRCEA_UPDATE_OCTET_WORDS
+#undef CRCEA_UPDATE_BY_OCTET_WORDS
 #undef CRCEA_UPDATE_BY1_OCTET
 #undef CRCEA_UPDATE_BY2_OCTET
 #undef CRCEA_UPDATE_BY4_OCTET
 #undef CRCEA_UPDATE_BY8_OCTET
 #undef CRCEA_UPDATE_BY16_OCTET
 #undef CRCEA_UPDATE_BY32_OCTET
+#undef CRCEA_UPDATE_BY8_OCTET_2WAY
+#undef CRCEA_INTERLEAVE_BUILD_SHIFT
 #undef CRCEA_UPDATE_BY2_SEXDECTET
 #undef CRCEA_UPDATE_BY4_SEXDECTET
 #undef CRCEA_UPDATE_BY8_SEXDECTET
 #undef CRCEA_UPDATE_BY16_SEXDECTET
 #undef CRCEA_UPDATE_BY32_SEXDECTET
+#undef CRCEA_UPDATE_CLMUL_FOLD
+#undef CRCEA_CLMUL_BUILD_CONSTANTS
+#undef CRCEA_UPDATE_VPCLMUL_FOLD
+#undef CRCEA_UPDATE_SSE42_CRC32C
 #undef CRCEA_BITSIZE
 #undef CRCEA_LSH
 #undef CRCEA_RSH
@@ -755,6 +1160,33 @@ CRCEA_END_C_DECL
 #undef CRCEA_INPUT_TO_STATE
 #undef CRCEA_UPDATE_SHIFT_DECL
 #undef CRCEA_UPDATE_SHIFT
+#undef CRCEA_SHIFT_STATE
+#undef CRCEA_GF2_ONE
+#undef CRCEA_GF2_MODULUS
+#undef CRCEA_GF2_MULMOD_DECL
+#undef CRCEA_GF2_MULMOD
+#undef CRCEA_GF2_SQUARE
+#undef CRCEA_GF2_MULX_DECL
+#undef CRCEA_GF2_MULX
+#undef CRCEA_GF2_XPOW
+#undef CRCEA_GF2_XPOW8N
+#undef CRCEA_GF2_INVERSE
+#undef CRCEA_COMBINE
+#undef CRCEA_UPDATE_ZEROS
+#undef CRCEA_UPDATEV
+#undef CRCEA_UPDATE_BITS
+#undef CRCEA_PATCH
+#undef CRCEA_UNUPDATE
+#undef CRCEA_UPDATE_REPEAT
+#undef CRCEA_ROLLING_BUILD_TABLE
+#undef CRCEA_ROLLING_SETUP
+#undef CRCEA_ROLLING_ROLL_DECL
+#undef CRCEA_ROLLING_ROLL
+#undef CRCEA_ROLLING_CRC
+#undef CRCEA_COMPILED_SETUP
+#undef CRCEA_COMPILED_UPDATE
+#undef CRCEA_COMPILED_FINISH
+#undef CRCEA_COMPILE_UPDATE
 #undef CRCEA_UPDATE_UNIFIED
 #undef CRCEA_UPDATE_REFERENCE
 #undef CRCEA_FALLBACK_DECL
@@ -796,10 +1228,15 @@ CRCEA_END_C_DECL
 #undef CRCEA_BY8_OCTET_DECL
 #undef CRCEA_BY16_OCTET_DECL
 #undef CRCEA_BY32_OCTET_DECL
+#undef CRCEA_INTERLEAVE_BUILD_SHIFT_DECL
+#undef CRCEA_INTERLEAVE_STEP8
+#undef CRCEA_BY8_OCTET_2WAY_DECL
 #undef CRCEA_BY2_SEXDECTET_DECL
 #undef CRCEA_BY4_SEXDECTET_DECL
 #undef CRCEA_BY8_SEXDECTET_DECL
 #undef CRCEA_BY16_SEXDECTET_DECL
 #undef CRCEA_BY32_SEXDECTET_DECL
+#undef CRCEA_CLMUL_FOLD_DECL
+#undef CRCEA_SSE42_CRC32C_DECL
 #undef CRCEA_BUILD_TABLE_DEFINE
 #undef CRCEA_BUILD_TABLE_DECL
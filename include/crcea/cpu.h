@@ -0,0 +1,110 @@
+/**
+ * @file cpu.h
+ * @brief 汎用 CRC 生成器
+ * @author dearblue <dearblue@users.osdn.me>
+ * @license Creative Commons Zero License (CC0 / Public Domain)
+ *
+ * 実行時の CPU 機能の判定
+ *
+ * CPUID 命令による判定は最初の呼び出しでのみ行われ、以降は記憶された値を返します。
+ * 同時に呼び出されても結果は同じ値なので、書き込みの競合は問題になりません。
+ *
+ * 記憶する値は crcea_cpu_features() の静的局所変数に置きます。
+ * crcea_cpu_features() は弱いシンボルとして各翻訳単位に定義され、
+ * リンク時に 1 つだけが選ばれるため、プログラム全体で判定は 1 度だけとなります。
+ */
+
+#ifndef CRCEA_CPU_H__
+#define CRCEA_CPU_H__ 1
+
+#include "defs.h"
+
+enum crcea_cpu_features
+{
+    CRCEA_CPU_PROBED        = 1 << 0,   /* 判定済みであることを示す */
+    CRCEA_CPU_SSSE3         = 1 << 1,
+    CRCEA_CPU_SSE42         = 1 << 2,
+    CRCEA_CPU_PCLMUL        = 1 << 3,
+    CRCEA_CPU_AVX2          = 1 << 4,
+    CRCEA_CPU_AVX512F       = 1 << 5,
+    CRCEA_CPU_AVX512BW      = 1 << 6,
+    CRCEA_CPU_AVX512VL      = 1 << 7,
+    CRCEA_CPU_VPCLMULQDQ    = 1 << 8,
+};
+
+#ifdef CRCEA_X86_64_SIMD
+
+#include <cpuid.h>
+
+static int
+crcea_cpu_probe(void)
+{
+    unsigned int a, b, c, d;
+    int f = CRCEA_CPU_PROBED;
+
+    if (!__get_cpuid(1, &a, &b, &c, &d)) {
+        return f;
+    }
+
+    if (c & bit_SSSE3) { f |= CRCEA_CPU_SSSE3; }
+    if (c & bit_SSE4_2) { f |= CRCEA_CPU_SSE42; }
+    if (c & bit_PCLMUL) { f |= CRCEA_CPU_PCLMUL; }
+
+    /* AVX 系は OS が YMM/ZMM レジスタを保存する場合に限り利用可能 */
+    if (!(c & bit_OSXSAVE)) {
+        return f;
+    }
+
+    unsigned int xlo, xhi;
+    __asm__ ("xgetbv" : "=a" (xlo), "=d" (xhi) : "c" (0));
+    int ymm = (xlo & 0x06) == 0x06;
+    int zmm = ymm && (xlo & 0xe0) == 0xe0;
+
+    if (!ymm || !__get_cpuid_count(7, 0, &a, &b, &c, &d)) {
+        return f;
+    }
+
+    if (b & bit_AVX2) { f |= CRCEA_CPU_AVX2; }
+    if (zmm) {
+        if (b & bit_AVX512F) { f |= CRCEA_CPU_AVX512F; }
+        if (b & bit_AVX512BW) { f |= CRCEA_CPU_AVX512BW; }
+        if (b & bit_AVX512VL) { f |= CRCEA_CPU_AVX512VL; }
+    }
+    if (c & (1u << 10)) { f |= CRCEA_CPU_VPCLMULQDQ; }  /* bit_VPCLMULQDQ */
+
+    return f;
+}
+
+int crcea_cpu_features(void);
+
+__attribute__((weak, noinline)) int
+crcea_cpu_features(void)
+{
+    static int cache;
+    int f = __atomic_load_n(&cache, __ATOMIC_RELAXED);
+
+    if (f == 0) {
+        f = crcea_cpu_probe();
+        __atomic_store_n(&cache, f, __ATOMIC_RELAXED);
+    }
+
+    return f;
+}
+
+#else
+
+static inline int
+crcea_cpu_features(void)
+{
+    return CRCEA_CPU_PROBED;
+}
+
+#endif /* CRCEA_X86_64_SIMD */
+
+static inline int
+crcea_cpu_supports(int features)
+{
+    return (crcea_cpu_features() & features) == features;
+}
+
+#endif /* CRCEA_CPU_H__ */
@@ -92,14 +92,30 @@
 # define CRCEA_ENABLE_BY8_OCTET
 # define CRCEA_ENABLE_BY16_OCTET
 # define CRCEA_ENABLE_BY32_OCTET
+# define CRCEA_ENABLE_BY8_OCTET_2WAY
 # define CRCEA_ENABLE_BY2_SEXDECTET
 # define CRCEA_ENABLE_BY4_SEXDECTET
 # define CRCEA_ENABLE_BY8_SEXDECTET
 # define CRCEA_ENABLE_BY16_SEXDECTET
 # define CRCEA_ENABLE_BY32_SEXDECTET
+# define CRCEA_ENABLE_CLMUL_FOLD
+# define CRCEA_ENABLE_VPCLMUL_FOLD
+# define CRCEA_ENABLE_SSE42_CRC32C
 
 #endif
 
+#if defined(CRCEA_ENABLE_VPCLMUL_FOLD) && !defined(CRCEA_ENABLE_CLMUL_FOLD)
+# define CRCEA_ENABLE_CLMUL_FOLD    /* CRCEA_VPCLMUL_FOLD は端数の処理に CRCEA_CLMUL_FOLD を用いる */
+#endif
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+# define CRCEA_LITTLE_ENDIAN 1
+#endif
+
+#if !defined(CRCEA_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+# define CRCEA_X86_64_SIMD 1
+#endif
+
 
 enum crcea_algorithms
 {
@@ -162,6 +178,18 @@ enum crcea_algorithms
     CRCEA_BY16_SEXDECTET        = 5 | CRCEA_BY_SEXDECTET_GROUP,
     CRCEA_BY32_SEXDECTET        = 6 | CRCEA_BY_SEXDECTET_GROUP,
 
+    CRCEA_CLMUL_GROUP           = 0x0600,
+    CRCEA_CLMUL_FOLD            = 1 | CRCEA_CLMUL_GROUP,
+    CRCEA_VPCLMUL_FOLD          = 2 | CRCEA_CLMUL_GROUP,
+
+    CRCEA_SSE42_GROUP           = 0x0700,
+    CRCEA_SSE42_CRC32C          = 1 | CRCEA_SSE42_GROUP,
+
+    CRCEA_INTERLEAVE_GROUP      = 0x0900,
+    CRCEA_BY8_OCTET_2WAY        = 2 | CRCEA_INTERLEAVE_GROUP,
+
+    CRCEA_AUTOMATIC             = 0x7f00,   /* crcea_prepare_table() で実行環境に合わせて決定される */
+
     CRCEA_HALFBYTE_TABLE        = CRCEA_BY_QUARTET,
     CRCEA_STANDARD_TABLE        = CRCEA_BY_OCTET,
     CRCEA_SLICING_BY_4          = CRCEA_BY4_OCTET,
@@ -169,10 +197,49 @@ enum crcea_algorithms
     CRCEA_SLICING_BY_16         = CRCEA_BY16_OCTET,
 };
 
+/*
+ * crcea_autotune() で計測する入力の長さの区分
+ */
+enum crcea_length_classes
+{
+    CRCEA_LENGTH_TINY           = 0,        /* 64 バイト以下 */
+    CRCEA_LENGTH_SMALL          = 1,        /* 1 KiB 以下 */
+    CRCEA_LENGTH_MEDIUM         = 2,        /* 64 KiB 以下 */
+    CRCEA_LENGTH_LARGE          = 3,        /* それ以上 */
+    CRCEA_LENGTH_CLASSES        = 4,
+
+    CRCEA_AUTOTUNE_TINY         = 1 << CRCEA_LENGTH_TINY,
+    CRCEA_AUTOTUNE_SMALL        = 1 << CRCEA_LENGTH_SMALL,
+    CRCEA_AUTOTUNE_MEDIUM       = 1 << CRCEA_LENGTH_MEDIUM,
+    CRCEA_AUTOTUNE_LARGE        = 1 << CRCEA_LENGTH_LARGE,
+    CRCEA_AUTOTUNE_ALL          = (1 << CRCEA_LENGTH_CLASSES) - 1,
+
+    CRCEA_TUNING_VERSION        = 1,        /* crcea_tuning の形式やアルゴリズムの値が変わるたびに増やす */
+};
+
 typedef struct crcea_design crcea_design;
 typedef struct crcea_model crcea_model;
 typedef struct crcea_context crcea_context;
+typedef struct crcea_rolling crcea_rolling;
+typedef struct crcea_compiled crcea_compiled;
+typedef struct crcea_arena crcea_arena;
+typedef struct crcea_tuning crcea_tuning;
+typedef struct crcea_adaptive crcea_adaptive;
+typedef struct crcea_iovec crcea_iovec;
 typedef void *(crcea_alloc_f)(void *opaque, size_t size);
+typedef void (crcea_free_f)(void *opaque, void *ptr);
+
+/*
+ * テーブルの先頭に望ましい境界。crcea_arena_alloc() はこの境界に揃えて割り当てる。
+ */
+#define CRCEA_TABLE_ALIGNMENT 64
+
+#ifdef __SIZEOF_INT128__
+/*
+ * CRCEA_TYPE として core.h に与えられる 128 ビットの整数型
+ */
+__extension__ typedef unsigned __int128 crcea_uint128;
+#endif
 
 #if defined(CRCEA_ONLY_INT32)
 typedef uint32_t crcea_int;
@@ -180,6 +247,11 @@ typedef uint32_t crcea_int;
 typedef uint16_t crcea_int;
 #elif defined(CRCEA_ONLY_INT8)
 typedef uint8_t crcea_int;
+#elif defined(CRCEA_ENABLE_INT128)
+# ifndef __SIZEOF_INT128__
+#  error CRCEA_ENABLE_INT128 requires the compiler supported 128 bits integer.
+# endif
+typedef crcea_uint128 crcea_int;
 #else /* defined(CRCEA_ONLY_INT64) */
 typedef uint64_t crcea_int;
 #endif
@@ -200,6 +272,9 @@ struct crcea_model
     crcea_int initialcrc;
 };
 
+/*
+ * 配置を変える場合は include/crcea.h の CRCEA_ABI_VERSION を増やすこと。
+ */
 struct crcea_context
 {
     const crcea_design *design;
@@ -207,6 +282,80 @@ struct crcea_context
     const void *table;
     crcea_alloc_f *alloc;
     void *opaque;       /*< for custom memory allocator */
+    crcea_free_f *free; /*< alloc で確保したテーブルを解放する。NULL であれば解放せず、複数のスレッドが同時に用意して cc->table に設定されなかったテーブルも残る */
+    crcea_adaptive *adaptive;   /*< crcea_adaptive_setup() で設定される */
+};
+
+/*
+ * crcea_update() に与えられた入力の長さから、小さなテーブルのアルゴリズムと
+ * 大きなテーブルのアルゴリズムを切り替えるための状態。
+ *
+ * const crcea_context を受け取る crcea_update() なども calls と current と histogram を
+ * 書き換えるため、書き込み可能な領域に置く必要がある。書き換えは原子操作で行われ、
+ * 同じ cc を複数のスレッドから同時に利用できる。
+ */
+struct crcea_adaptive
+{
+    int16_t algorithm[2];   /*< 小さな入力用と大きな入力用 */
+    const void *table[2];
+    uint32_t interval;      /*< 切り替えを判断する crcea_update() の呼び出し回数 */
+    uint32_t calls;
+    int current;            /*< 利用している algorithm[] の添字 */
+    size_t histogram[CRCEA_LENGTH_CLASSES];     /*< 区分ごとの入力のバイト数 */
+};
+
+/*
+ * crcea_updatev() に与える領域。struct iovec と同じ並び。
+ */
+struct crcea_iovec
+{
+    const void *base;
+    size_t len;
+};
+
+/*
+ * crcea_arena_alloc() の opaque として渡す、利用者が用意した領域
+ */
+struct crcea_arena
+{
+    void *buffer;
+    size_t size;
+    size_t used;        /*< 0 に戻すとまとめて解放される */
+};
+
+struct crcea_rolling
+{
+    const crcea_context *context;
+    const void *table;  /*< crcea_rolling_setup() で確保される */
+    crcea_int base;
+    crcea_int unshift;
+    crcea_int state;    /*< 0 から計算された窓の内部状態 */
+};
+
+/*
+ * crcea_autotune() の結果。値は enum crcea_algorithms と enum crcea_cpu_features のままで、そのまま保存できる。
+ *
+ * 保存した値は crcea_tuning_apply() で version と cpu を確かめてから用いる。
+ */
+struct crcea_tuning
+{
+    int32_t version;    /*< 記録した時の CRCEA_TUNING_VERSION */
+    int32_t cpu;        /*< 計測した CPU の crcea_cpu_features() */
+    int16_t algorithm[CRCEA_LENGTH_CLASSES];
+};
+
+typedef crcea_int (crcea_setup_f)(const crcea_design *design, crcea_int crc);
+typedef crcea_int (crcea_update_f)(const crcea_compiled *cp, const void *src, const void *srcend, crcea_int state);
+typedef crcea_int (crcea_finish_f)(const crcea_design *design, crcea_int state);
+
+struct crcea_compiled
+{
+    const crcea_design *design;
+    int16_t algorithm;  /*< CRCEA_AUTOMATIC は解決済み */
+    const void *table;
+    crcea_setup_f *setup;
+    crcea_update_f *update;
+    crcea_finish_f *finish;
 };
 
 #endif /* CRCEA_DEFS_H__ */
@@ -11,8 +11,55 @@
  *
  * [CRCEA_DEFAULT_MALLOC]
  *      Optional.
+ *
+ * [CRCEA_DEFAULT_FREE]
+ *      Optional.
+ *      The shared tables are never released if CRCEA_DEFAULT_MALLOC is
+ *      given without this.
+ *
+ * [CRCEA_ENABLE_PARALLEL]
+ *      Optional, not defined by default.
+ *      crcea_update_parallel() uses a pool of POSIX threads, and -lpthread
+ *      is needed to link. Without this, crcea_update_parallel() is done by
+ *      the calling thread only.
+ *
+ * [CRCEA_NO_THREADS]
+ *      Optional, not defined by default.
+ *      The shared table cache is not locked, and CRCEA_ENABLE_PARALLEL is
+ *      ignored.
+ *
+ * [CRCEA_ENABLE_INT128]
+ *      Optional, not defined by default.
+ *      crcea_int becomes 128 bits, and the designs wider than 64 bits are
+ *      done by the instantiation of crcea_uint128.
+ *      The same definision is needed by the users of include/crcea.h.
+ *
+ * [CRCEA_PARALLEL_MINSIZE]
+ *      Optional, 1 MiB by default.
+ *      The minimum bytes per thread when the number of threads is automatic.
+ *
+ * [CRCEA_PARALLEL_MAXTHREADS]
+ *      Optional, 256 by default.
+ *      The maximum number of threads of crcea_update_parallel().
+ *      The worker threads are kept in a pool until crcea_parallel_shutdown().
  */
 
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+
+#if defined(CRCEA_ENABLE_PARALLEL) && defined(CRCEA_NO_THREADS)
+#   undef CRCEA_ENABLE_PARALLEL
+#endif
+
+#ifndef CRCEA_NO_THREADS
+#   include <sched.h>
+#endif
+
+#ifdef CRCEA_ENABLE_PARALLEL
+#   include <pthread.h>
+#   include <unistd.h>
+#endif
+
 #ifndef CRCEA_DEFAULT
 #   define CRCEA_ACADEMIC
 #endif
@@ -21,9 +68,14 @@
 
 #if !defined(CRCEA_NO_MALLOC) && !defined(CRCEA_DEFAULT_MALLOC)
 #   define CRCEA_DEFAULT_MALLOC crcea_default_malloc
+#   define CRCEA_DEFAULT_FREE crcea_default_free
 static void *CRCEA_DEFAULT_MALLOC(void *opaque, size_t size);
+static void CRCEA_DEFAULT_FREE(void *opaque, void *ptr);
 #elif defined(CRCEA_DEFAULT_MALLOC)
 void *CRCEA_DEFAULT_MALLOC(void *opaque, size_t size);
+#   ifdef CRCEA_DEFAULT_FREE
+void CRCEA_DEFAULT_FREE(void *opaque, void *ptr);
+#   endif
 #endif
 
 #if defined(CRCEA_ONLY_INT64)
@@ -89,19 +141,51 @@ void *CRCEA_DEFAULT_MALLOC(void *opaque, size_t size);
 #   define CRCEA_TYPE        uint64_t
 #   include "../include/crcea/core.h"
 
-#   define CRCEA_SWITCH_BY_TYPE(D, F)                                       \
-        do {                                                                \
-            if ((D)->bitsize > 32) {                                        \
-                F(uint64_t, crcea64);                                       \
-            } else if ((D)->bitsize > 16) {                                 \
-                F(uint32_t, crcea32);                                       \
-            } else {                                                        \
-                F(uint16_t, crcea16);                                       \
-            }                                                               \
-        } while (0)                                                         \
+#   ifdef CRCEA_ENABLE_INT128
+#       define CRCEA_PREFIX      crcea128
+#       define CRCEA_TYPE        crcea_uint128
+#       include "../include/crcea/core.h"
+
+#       define CRCEA_SWITCH_BY_TYPE(D, F)                                   \
+            do {                                                            \
+                if ((D)->bitsize > 64) {                                    \
+                    F(crcea_uint128, crcea128);                             \
+                } else if ((D)->bitsize > 32) {                             \
+                    F(uint64_t, crcea64);                                   \
+                } else if ((D)->bitsize > 16) {                             \
+                    F(uint32_t, crcea32);                                   \
+                } else {                                                    \
+                    F(uint16_t, crcea16);                                   \
+                }                                                           \
+            } while (0)                                                     \
+
+#   else
+#       define CRCEA_SWITCH_BY_TYPE(D, F)                                   \
+            do {                                                            \
+                if ((D)->bitsize > 32) {                                    \
+                    F(uint64_t, crcea64);                                   \
+                } else if ((D)->bitsize > 16) {                             \
+                    F(uint32_t, crcea32);                                   \
+                } else {                                                    \
+                    F(uint16_t, crcea16);                                   \
+                }                                                           \
+            } while (0)                                                     \
+
+#   endif
 
 #endif /* CRCEA_ONLY_UINT*** */
 
+/*
+ * 構築された時の CRCEA_ABI_VERSION を返す。
+ *
+ * 利用者はこれが自身の構築した時の CRCEA_ABI_VERSION と一致することを確かめられる。
+ */
+int
+crcea_abi_version(void)
+{
+    return CRCEA_ABI_VERSION;
+}
+
 size_t
 crcea_tablesize(const crcea_context *cc)
 {
@@ -113,34 +197,294 @@ crcea_tablesize(const crcea_context *cc)
 }
 
 int
-crcea_prepare_table(crcea_context *cc)
+crcea_select_algorithm(const crcea_design *design, int algo)
 {
-    int algo = cc->algorithm;
+#define CRCEA_SELECT_ALGORITHM_DECL(T, P) return P ## _select_algorithm(design, algo)
+
+    CRCEA_SWITCH_BY_TYPE(design, CRCEA_SELECT_ALGORITHM_DECL);
+
+    return algo;
+}
+
+#if defined(__GNUC__)
+#   define CRCEA_ATOMIC_LOAD(P)         __atomic_load_n(P, __ATOMIC_ACQUIRE)
+#   define CRCEA_ATOMIC_STORE(P, V)     __atomic_store_n(P, V, __ATOMIC_RELEASE)
+#   define CRCEA_ATOMIC_CAS(P, E, V)    __atomic_compare_exchange_n(P, E, V, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#   define CRCEA_ATOMIC_EXCHANGE(P, V)  __atomic_exchange_n(P, V, __ATOMIC_ACQ_REL)
+#   define CRCEA_ATOMIC_ADD(P, V)       __atomic_add_fetch(P, V, __ATOMIC_RELAXED)
+#else
+#   define CRCEA_ATOMIC_LOAD(P)         (*(P))
+#   define CRCEA_ATOMIC_STORE(P, V)     (*(P) = (V))
+#   define CRCEA_ATOMIC_CAS(P, E, V)    (*(P) == *(E) ? (*(P) = (V), 1) : (*(E) = *(P), 0))
+#   define CRCEA_ATOMIC_EXCHANGE(P, V)  crcea_exchange_table(P, V)
+#   define CRCEA_ATOMIC_ADD(P, V)       (*(P) += (V))
+
+static const void *
+crcea_exchange_table(const void **p, const void *v)
+{
+    const void *old = *p;
+    *p = v;
+    return old;
+}
+#endif
 
-    if (!cc->table && algo >= CRCEA_TABLE_ALGORITHM) {
-        crcea_alloc_f *alloc = cc->alloc;
-        if (!alloc) {
 #ifdef CRCEA_DEFAULT_MALLOC
-            alloc = CRCEA_DEFAULT_MALLOC;
+/*
+ * alloc が NULL の crcea_context で共有されるテーブル。
+ *
+ * テーブルの内容は生成多項式と reflectin と型の幅 (bitsize から決まる) だけに依存するため、
+ * reflectout や appendzero、xoroutput が異なる設計でも同じテーブルを使う。
+ */
+typedef struct crcea_table_cache
+{
+    struct crcea_table_cache *next;
+    crcea_int polynomial;
+    uint8_t bitsize;
+    uint8_t reflectin;
+    int16_t algorithm;
+    int ready;          /* 構築中は 0 */
+    size_t refcount;
+    void *table;
+} crcea_table_cache;
+
+#define CRCEA_TABLE_CACHE_HEADER ((sizeof(crcea_table_cache) + 63) & ~(size_t)63)
+
+static crcea_table_cache *crcea_table_cache_list = NULL;
+
+#ifndef CRCEA_NO_THREADS
+/*
+ * キャッシュの一覧を守るロック。
+ *
+ * 一覧をたどる間しか持たないため、libpthread に依存しないように原子操作と sched_yield() で待つ。
+ */
+static int crcea_table_cache_locked = 0;
+
+static void
+crcea_table_cache_lock(void)
+{
+    int expect = 0;
+
+    while (!CRCEA_ATOMIC_CAS(&crcea_table_cache_locked, &expect, 1)) {
+        expect = 0;
+        sched_yield();
+    }
+}
+
+#   define CRCEA_TABLE_CACHE_LOCK()     crcea_table_cache_lock()
+#   define CRCEA_TABLE_CACHE_UNLOCK()   CRCEA_ATOMIC_STORE(&crcea_table_cache_locked, 0)
+#   define CRCEA_TABLE_CACHE_WAIT()     (CRCEA_TABLE_CACHE_UNLOCK(), sched_yield(), CRCEA_TABLE_CACHE_LOCK())
+#   define CRCEA_TABLE_CACHE_WAKE()     ((void)0)
 #else
-            return CRCEA_FALLBACK;
+#   define CRCEA_TABLE_CACHE_LOCK()     ((void)0)
+#   define CRCEA_TABLE_CACHE_UNLOCK()   ((void)0)
+#   define CRCEA_TABLE_CACHE_WAIT()     ((void)0)
+#   define CRCEA_TABLE_CACHE_WAKE()     ((void)0)
 #endif
+
+/*
+ * design と algo に対するテーブルを参照カウントを増やして返す。
+ *
+ * 見つからなければ構築中の項目を登録し、ロックを外してから構築する。
+ * 大きなテーブルの構築中も他の設計のテーブルは取得でき、
+ * 同じテーブルを求めたスレッドは構築が終わるまで待つため、同じテーブルが並行して構築されることはない。
+ */
+static const void *
+crcea_table_cache_acquire(const crcea_design *design, int algo, size_t size)
+{
+    crcea_int poly = design->polynomial & (~(crcea_int)0 >> (sizeof(crcea_int) * 8 - design->bitsize));
+    crcea_table_cache *e;
+
+    CRCEA_TABLE_CACHE_LOCK();
+
+    for (e = crcea_table_cache_list; e; e = e->next) {
+        if (e->polynomial == poly && e->bitsize == design->bitsize &&
+            e->reflectin == design->reflectin && e->algorithm == algo) {
+            break;
         }
+    }
+
+    if (e) {
+        e->refcount ++;
+
+        while (!e->ready) {
+            CRCEA_TABLE_CACHE_WAIT();
+        }
+
+        CRCEA_TABLE_CACHE_UNLOCK();
+
+        return e->table;
+    }
 
-        if (alloc) {
-            void *table = alloc(cc->opaque, crcea_tablesize(cc));
+    /* テーブルは管理情報と同じ領域の、CRCEA_TABLE_CACHE_HEADER バイト目から置かれる */
+    e = (crcea_table_cache *)CRCEA_DEFAULT_MALLOC(NULL, CRCEA_TABLE_CACHE_HEADER + size);
+    if (!e) {
+        CRCEA_TABLE_CACHE_UNLOCK();
+        return NULL;
+    }
+
+    e->polynomial = poly;
+    e->bitsize = design->bitsize;
+    e->reflectin = design->reflectin;
+    e->algorithm = algo;
+    e->ready = 0;
+    e->refcount = 1;
+    e->table = (char *)e + CRCEA_TABLE_CACHE_HEADER;
+    e->next = crcea_table_cache_list;
+    crcea_table_cache_list = e;
+
+    CRCEA_TABLE_CACHE_UNLOCK();
+
+    crcea_build_table(design, algo, e->table);
+
+    CRCEA_TABLE_CACHE_LOCK();
+    e->ready = 1;
+    CRCEA_TABLE_CACHE_WAKE();
+    CRCEA_TABLE_CACHE_UNLOCK();
+
+    return e->table;
+}
+
+/*
+ * crcea_table_cache_acquire() で得たテーブルの参照カウントを減らし、0 になれば解放する。
+ *
+ * キャッシュにないテーブルであれば何もしない。
+ */
+static void
+crcea_table_cache_unref(const void *table)
+{
+    CRCEA_TABLE_CACHE_LOCK();
+
+    for (crcea_table_cache **ep = &crcea_table_cache_list; *ep; ep = &(*ep)->next) {
+        crcea_table_cache *e = *ep;
+
+        if (e->table == table) {
+            e->refcount --;
+#ifdef CRCEA_DEFAULT_FREE
+            if (e->refcount == 0) {
+                *ep = e->next;
+                CRCEA_DEFAULT_FREE(NULL, e);
+            }
+#endif
+            break;
+        }
+    }
+
+    CRCEA_TABLE_CACHE_UNLOCK();
+}
+#endif /* CRCEA_DEFAULT_MALLOC */
+
+/*
+ * cc->table に設定されていない table を解放する
+ */
+static void
+crcea_release_unused_table(const crcea_context *cc, const void *table)
+{
+    if (cc->alloc) {
+        if (cc->free) {
+            (*cc->free)(cc->opaque, (void *)table);
+        }
+    } else {
+#ifdef CRCEA_DEFAULT_MALLOC
+        crcea_table_cache_unref(table);
+#endif
+    }
+}
+
+/*
+ * cc->algorithm を解決し、必要であればテーブルを用意する。
+ *
+ * cc->alloc が NULL であれば、テーブルはプロセス内の同じ設計の crcea_context で共有される。
+ * 複数のスレッドから同じ cc に対して呼ばれてもよく、cc->table は compare-and-swap で一度だけ設定される。
+ */
+int
+crcea_prepare_table(crcea_context *cc)
+{
+    int algo = CRCEA_ATOMIC_LOAD(&cc->algorithm);
+
+    if (algo == CRCEA_AUTOMATIC) {
+        algo = crcea_select_algorithm(cc->design, algo);
+        CRCEA_ATOMIC_STORE(&cc->algorithm, (int16_t)algo);
+    }
+
+    if (algo >= CRCEA_TABLE_ALGORITHM && !CRCEA_ATOMIC_LOAD(&cc->table)) {
+        const void *table, *expect = NULL;
+
+        if (cc->alloc) {
+            void *p = cc->alloc(cc->opaque, crcea_tablesize(cc));
+            if (!p) {
+                return CRCEA_FALLBACK;
+            }
+
+            crcea_build_table(cc->design, algo, p);
+            table = p;
+        } else {
+#ifdef CRCEA_DEFAULT_MALLOC
+            table = crcea_table_cache_acquire(cc->design, algo, crcea_tablesize(cc));
             if (!table) {
                 return CRCEA_FALLBACK;
             }
+#else
+            return CRCEA_FALLBACK;
+#endif
+        }
 
-            crcea_build_table(cc->design, algo, table);
-            cc->table = table;
+        if (!CRCEA_ATOMIC_CAS(&cc->table, &expect, table)) {
+            /* 他のスレッドが先に設定した */
+            crcea_release_unused_table(cc, table);
         }
     }
 
     return algo;
 }
 
+/*
+ * cc->table を NULL にして、テーブルを確保した方法で解放する。
+ *
+ * 共有されたテーブルは最後の参照が解放された時に解放される。
+ * cc->alloc で確保したテーブルは cc->free が NULL であれば解放されない。
+ */
+void
+crcea_release_table(crcea_context *cc)
+{
+    const void *table = CRCEA_ATOMIC_EXCHANGE(&cc->table, NULL);
+
+    if (table) {
+        crcea_release_unused_table(cc, table);
+    }
+
+    if (cc->adaptive) {
+        for (int k = 0; k < 2; k ++) {
+            table = CRCEA_ATOMIC_EXCHANGE(&cc->adaptive->table[k], NULL);
+            if (table) {
+                crcea_release_unused_table(cc, table);
+            }
+        }
+    }
+}
+
+/*
+ * crcea_arena を opaque とする crcea_alloc_f。
+ *
+ * 領域の残りから CRCEA_TABLE_ALIGNMENT に揃えて割り当て、足りなければ NULL を返す。
+ * 個別の解放は出来ないため cc->free は NULL とし、arena->used を 0 に戻してまとめて解放する。
+ * 同じ arena を複数のスレッドから同時に使うことは出来ない。
+ */
+void *
+crcea_arena_alloc(void *opaque, size_t size)
+{
+    crcea_arena *arena = (crcea_arena *)opaque;
+    uintptr_t base = (uintptr_t)arena->buffer;
+    uintptr_t head = (base + arena->used + (CRCEA_TABLE_ALIGNMENT - 1)) & ~(uintptr_t)(CRCEA_TABLE_ALIGNMENT - 1);
+
+    if (head - base > arena->size || size > arena->size - (head - base)) {
+        return NULL;
+    }
+
+    arena->used = head - base + size;
+
+    return (void *)head;
+}
+
 void
 crcea_build_table(const crcea_design *design, int algo, void *table)
 {
@@ -159,12 +503,117 @@ crcea_setup(const crcea_context *cc, crcea_int crc)
     return ~(crcea_int)0;
 }
 
+#define CRCEA_ADAPTIVE_INTERVAL 4096
+
+/*
+ * 小さなテーブルのアルゴリズムを small、大きなテーブルのアルゴリズムを large として、
+ * crcea_update() で interval 回ごとに入力の長さの分布から切り替えるようにする。
+ *
+ * small が CRCEA_AUTOMATIC であれば CRCEA_BY4_QUARTET、large が CRCEA_AUTOMATIC であれば
+ * crcea_select_algorithm() の結果とする。interval が 0 であれば CRCEA_ADAPTIVE_INTERVAL とする。
+ * テーブルは cc->alloc で確保され、crcea_release_table() で解放される。
+ * cc に既に adaptive が設定されていれば、そのテーブルを解放してから設定し直す。
+ * cc を他のスレッドが利用している間に呼んではならない。
+ *
+ * 失敗した場合は 0 以外を返す。
+ */
+int
+crcea_adaptive_setup(crcea_context *cc, crcea_adaptive *adaptive, int small, int large, uint32_t interval)
+{
+    if (cc->adaptive) {
+        for (int k = 0; k < 2; k ++) {
+            if (cc->adaptive->table[k]) {
+                crcea_release_unused_table(cc, cc->adaptive->table[k]);
+                cc->adaptive->table[k] = NULL;
+            }
+        }
+        cc->adaptive = NULL;
+    }
+
+    if (small == CRCEA_AUTOMATIC) {
+        small = CRCEA_BY4_QUARTET;
+    }
+
+    if (large == CRCEA_AUTOMATIC) {
+        large = crcea_select_algorithm(cc->design, CRCEA_AUTOMATIC);
+    }
+
+    int algo[2] = { small, large };
+
+    for (int k = 0; k < 2; k ++) {
+        crcea_context c = *cc;
+        c.algorithm = algo[k];
+        c.table = NULL;
+        c.adaptive = NULL;
+
+        adaptive->algorithm[k] = crcea_prepare_table(&c);
+        adaptive->table[k] = c.table;
+        if (adaptive->algorithm[k] != algo[k]) {
+            for (int i = 0; i <= k; i ++) {
+                if (adaptive->table[i]) {
+                    crcea_release_unused_table(cc, adaptive->table[i]);
+                }
+            }
+            return 1;
+        }
+    }
+
+    adaptive->interval = (interval > 0 ? interval : CRCEA_ADAPTIVE_INTERVAL);
+    adaptive->calls = 0;
+    adaptive->current = 0;
+    for (int k = 0; k < CRCEA_LENGTH_CLASSES; k ++) {
+        adaptive->histogram[k] = 0;
+    }
+
+    cc->adaptive = adaptive;
+
+    return 0;
+}
+
+/*
+ * len バイトの入力を数えて、利用するアルゴリズムとテーブルを返す。
+ *
+ * interval 回ごとに、64 KiB 以下と 64 KiB を超える入力のバイト数の
+ * 多い方に合わせてアルゴリズムを切り替え、分布を半分にして古い入力の影響を減らす。
+ * 複数のスレッドから呼ばれた場合の数え漏れは許容する。
+ *
+ * const crcea_context を受け取る関数からも呼ばれ、cc->adaptive の指す先を書き換える。
+ */
+static void
+crcea_adaptive_select(crcea_adaptive *ad, size_t len, int *algo, const void **table)
+{
+    CRCEA_ATOMIC_ADD(&ad->histogram[crcea_length_class(len)], len);
+
+    if (CRCEA_ATOMIC_ADD(&ad->calls, 1) % ad->interval == 0) {
+        size_t h[CRCEA_LENGTH_CLASSES];
+
+        for (int k = 0; k < CRCEA_LENGTH_CLASSES; k ++) {
+            h[k] = CRCEA_ATOMIC_LOAD(&ad->histogram[k]);
+            CRCEA_ATOMIC_STORE(&ad->histogram[k], h[k] / 2);
+        }
+
+        int bulk = (h[CRCEA_LENGTH_MEDIUM] + h[CRCEA_LENGTH_LARGE] > h[CRCEA_LENGTH_TINY] + h[CRCEA_LENGTH_SMALL]);
+        CRCEA_ATOMIC_STORE(&ad->current, bulk);
+    }
+
+    int k = CRCEA_ATOMIC_LOAD(&ad->current);
+    *algo = ad->algorithm[k];
+    *table = ad->table[k];
+}
+
 crcea_int
 crcea_update(const crcea_context *cc, const void *p, const void *pp, crcea_int state)
 {
+    int algo = cc->algorithm;
+    const void *table = cc->table;
+
+    if (cc->adaptive) {
+        crcea_adaptive_select(cc->adaptive, (const char *)pp - (const char *)p, &algo, &table);
+    }
+
 #define CRCEA_UPDATE(T, P)                                                  \
     do {                                                                    \
-        return P ## _update(cc->design, p, pp, state, cc->algorithm, cc->table); \
+        return P ## _update(cc->design, p, pp, state, algo, table);         \
     } while (0);                                                            \
 
     CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_UPDATE);
@@ -172,6 +621,75 @@ crcea_update(const crcea_context *cc, const void *p, const void *pp, crcea_int s
     return state;
 }
 
+crcea_int
+crcea_updatev(const crcea_context *cc, const crcea_iovec *iov, size_t iovcnt, crcea_int state)
+{
+    int algo = cc->algorithm;
+    const void *table = cc->table;
+
+    if (cc->adaptive) {
+        size_t len = 0;
+        for (size_t i = 0; i < iovcnt; i ++) {
+            len += iov[i].len;
+        }
+
+        crcea_adaptive_select(cc->adaptive, len, &algo, &table);
+    }
+
+#define CRCEA_UPDATEV(T, P) return P ## _updatev(cc->design, iov, iovcnt, state, algo, table)
+
+    CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_UPDATEV);
+
+    return state;
+}
+
+crcea_int
+crcea_update_bits(const crcea_context *cc, const void *p, size_t nbits, crcea_int state)
+{
+    int algo = cc->algorithm;
+    const void *table = cc->table;
+
+    if (cc->adaptive) {
+        crcea_adaptive_select(cc->adaptive, nbits / 8, &algo, &table);
+    }
+
+#define CRCEA_UPDATE_BITS(T, P) return P ## _update_bits(cc->design, (const char *)p, nbits, state, algo, table)
+
+    CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_UPDATE_BITS);
+
+    return state;
+}
+
+crcea_int
+crcea_update_zeros(const crcea_context *cc, uint64_t n, crcea_int state)
+{
+#define CRCEA_UPDATE_ZEROS(T, P) return P ## _update_zeros(cc->design, n, state)
+
+    CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_UPDATE_ZEROS);
+
+    return state;
+}
+
+crcea_int
+crcea_update_repeat(const crcea_context *cc, const void *p, const void *pp, uint64_t times, crcea_int state)
+{
+#define CRCEA_UPDATE_REPEAT(T, P) return P ## _update_repeat(cc->design, p, pp, times, state, cc->algorithm, cc->table)
+
+    CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_UPDATE_REPEAT);
+
+    return state;
+}
+
+crcea_int
+crcea_unupdate(const crcea_context *cc, const void *p, const void *pp, crcea_int state)
+{
+#define CRCEA_UNUPDATE(T, P) return P ## _unupdate(cc->design, p, pp, state, cc->algorithm, cc->table)
+
+    CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_UNUPDATE);
+
+    return state;
+}
+
 crcea_int
 crcea_finish(const crcea_context *cc, crcea_int state)
 {
@@ -190,6 +708,604 @@ crcea(const crcea_context *cc, const void *src, const void *srcend, crcea_int cr
     return crcea_finish(cc, s);
 }
 
+#ifndef CRCEA_PARALLEL_MINSIZE
+#   define CRCEA_PARALLEL_MINSIZE (1 << 20)
+#endif
+
+#ifndef CRCEA_PARALLEL_MAXTHREADS
+#   define CRCEA_PARALLEL_MAXTHREADS 256
+#endif
+
+#ifdef CRCEA_ENABLE_PARALLEL
+/*
+ * crcea_update_parallel() の 1 回の呼び出し。呼び出し元のスタックに置かれる。
+ *
+ * 入力は threads 個の区間に分けられ、区間を取り出したスレッドが
+ * 区間の後ろのバイト数だけずらした内部状態を state に足し込む。
+ * 区間ごとの結果を保持しないため、区間の数によらず大きさは一定となる。
+ */
+typedef struct crcea_parallel_job
+{
+    struct crcea_parallel_job *next;
+    const crcea_context *cc;
+    const char *p, *pp;
+    size_t each;
+    int threads;
+    int taken;          /* 取り出された区間の数 */
+    int remain;         /* 終わっていない区間の数 */
+    crcea_int state;
+} crcea_parallel_job;
+
+/*
+ * 呼び出しの間で使い回されるスレッドのプール。
+ *
+ * スレッドは必要になった時に CRCEA_PARALLEL_MAXTHREADS - 1 個まで起動され、
+ * crcea_parallel_shutdown() で終了するまで待機し続ける。
+ */
+static pthread_mutex_t crcea_parallel_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t crcea_parallel_queued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t crcea_parallel_done = PTHREAD_COND_INITIALIZER;
+static crcea_parallel_job *crcea_parallel_queue = NULL;
+static pthread_t crcea_parallel_threads[CRCEA_PARALLEL_MAXTHREADS - 1];
+static int crcea_parallel_workers = 0;
+static int crcea_parallel_stopping = 0;    /* crcea_parallel_shutdown() の途中は 1 */
+
+/*
+ * job の区間を 1 つ処理する。crcea_parallel_mutex を持った状態で呼び、持った状態で戻る。
+ */
+static void
+crcea_parallel_run(crcea_parallel_job *job)
+{
+    int i = job->taken ++;
+
+    if (job->taken == job->threads) {
+        /* 残りの区間がなくなったので待ち行列から外す */
+        crcea_parallel_job **jp = &crcea_parallel_queue;
+        while (*jp != job) { jp = &(*jp)->next; }
+        *jp = job->next;
+    }
+
+    pthread_mutex_unlock(&crcea_parallel_mutex);
+
+    const char *p = job->p + job->each * i;
+    const char *pp = (i + 1 < job->threads ? p + job->each : job->pp);
+    crcea_int state = crcea_update(job->cc, p, pp, 0);
+    state = crcea_update_zeros(job->cc, job->pp - pp, state);
+
+    pthread_mutex_lock(&crcea_parallel_mutex);
+
+    job->state ^= state;
+    if (-- job->remain == 0) {
+        pthread_cond_broadcast(&crcea_parallel_done);
+    }
+}
+
+static void *
+crcea_parallel_worker(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&crcea_parallel_mutex);
+
+    for (;;) {
+        while (!crcea_parallel_queue && !crcea_parallel_stopping) {
+            pthread_cond_wait(&crcea_parallel_queued, &crcea_parallel_mutex);
+        }
+
+        if (!crcea_parallel_queue) {
+            break;
+        }
+
+        crcea_parallel_run(crcea_parallel_queue);
+    }
+
+    pthread_mutex_unlock(&crcea_parallel_mutex);
+
+    return NULL;
+}
+
+/*
+ * プールのスレッドが workers 個以上となるように起動する。crcea_parallel_mutex を持った状態で呼ぶ。
+ *
+ * 起動できなかった場合や crcea_parallel_shutdown() の途中でも、
+ * 区間は呼び出し元のスレッドが処理するため失敗とはしない。
+ */
+static void
+crcea_parallel_spawn(int workers)
+{
+    if (crcea_parallel_stopping) {
+        return;
+    }
+
+    while (crcea_parallel_workers < workers) {
+        if (pthread_create(&crcea_parallel_threads[crcea_parallel_workers], NULL, crcea_parallel_worker, NULL) != 0) {
+            break;
+        }
+
+        crcea_parallel_workers ++;
+    }
+}
+#endif
+
+/*
+ * crcea_update_parallel() のプールのスレッドを全て終了させ、終わるまで待つ。
+ *
+ * 処理中の呼び出しがあれば、その区間を終えてからスレッドは終了する。
+ * 次の crcea_update_parallel() で必要になれば、スレッドは再び起動される。
+ * 共有ライブラリとして読み込んだ場合は、dlclose() の前に呼ぶ必要がある。
+ */
+void
+crcea_parallel_shutdown(void)
+{
+#ifdef CRCEA_ENABLE_PARALLEL
+    pthread_mutex_lock(&crcea_parallel_mutex);
+
+    if (crcea_parallel_stopping) {
+        /* 他のスレッドが終了させている */
+        pthread_mutex_unlock(&crcea_parallel_mutex);
+        return;
+    }
+
+    int workers = crcea_parallel_workers;
+    crcea_parallel_stopping = 1;
+    pthread_cond_broadcast(&crcea_parallel_queued);
+    pthread_mutex_unlock(&crcea_parallel_mutex);
+
+    for (int i = 0; i < workers; i ++) {
+        pthread_join(crcea_parallel_threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&crcea_parallel_mutex);
+    crcea_parallel_workers = 0;
+    crcea_parallel_stopping = 0;
+    pthread_mutex_unlock(&crcea_parallel_mutex);
+#endif
+}
+
+/*
+ * 入力を threads 個に分割してそれぞれのスレッドで処理し、x^n mod P を掛けて結合する。
+ *
+ * threads が 0 以下であれば、オンラインの CPU の数を上限として
+ * スレッドあたり CRCEA_PARALLEL_MINSIZE バイト以上となるように決める。
+ * 各スレッドが予備の処理に落ちることのないよう、cc のテーブルは最初に crcea_prepare_table() で用意する。
+ */
+crcea_int
+crcea_update_parallel(crcea_context *cc, const void *src, const void *srcend, crcea_int state, int threads)
+{
+    crcea_prepare_table(cc);
+
+#ifdef CRCEA_ENABLE_PARALLEL
+    size_t len = (const char *)srcend - (const char *)src;
+
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        size_t most = len / CRCEA_PARALLEL_MINSIZE;
+        threads = (cpus > 1 ? (int)(cpus < CRCEA_PARALLEL_MAXTHREADS ? cpus : CRCEA_PARALLEL_MAXTHREADS) : 1);
+        if ((size_t)threads > most) { threads = (int)most; }
+    }
+
+    if (threads > CRCEA_PARALLEL_MAXTHREADS) { threads = CRCEA_PARALLEL_MAXTHREADS; }
+    if ((size_t)threads > len) { threads = (int)len; }
+
+    if (threads > 1) {
+        crcea_parallel_job job = {
+            .next = NULL,
+            .cc = cc,
+            .p = (const char *)src,
+            .pp = (const char *)srcend,
+            .each = len / threads,
+            .threads = threads,
+            .taken = 0,
+            .remain = threads,
+            .state = crcea_update_zeros(cc, len, state),
+        };
+
+        pthread_mutex_lock(&crcea_parallel_mutex);
+
+        crcea_parallel_spawn(threads - 1);
+        job.next = crcea_parallel_queue;
+        crcea_parallel_queue = &job;
+        pthread_cond_broadcast(&crcea_parallel_queued);
+
+        /* プールのスレッドが取り出さなかった区間は呼び出し元で処理する */
+        while (job.taken < job.threads) {
+            crcea_parallel_run(&job);
+        }
+
+        while (job.remain > 0) {
+            pthread_cond_wait(&crcea_parallel_done, &crcea_parallel_mutex);
+        }
+
+        pthread_mutex_unlock(&crcea_parallel_mutex);
+
+        return job.state;
+    }
+#else
+    (void)threads;
+#endif
+
+    return crcea_update(cc, src, srcend, state);
+}
+
+crcea_int
+crcea_combine(const crcea_context *cc, crcea_int crca, crcea_int crcb, uint64_t lenb)
+{
+#define CRCEA_COMBINE(T, P) return P ## _combine(cc->design, crca, crcb, lenb)
+
+    CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_COMBINE);
+
+    return ~(crcea_int)0;
+}
+
+crcea_int
+crcea_patch(const crcea_context *cc, crcea_int crc, uint64_t total, uint64_t offset, const void *oldbytes, const void *newbytes, size_t n)
+{
+#define CRCEA_PATCH(T, P) return P ## _patch(cc->design, crc, total, offset, oldbytes, newbytes, n, cc->algorithm, cc->table)
+
+    CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_PATCH);
+
+    return ~(crcea_int)0;
+}
+
+/*
+ * 失敗した場合は 0 以外を返す
+ */
+int
+crcea_rolling_setup(crcea_rolling *rc, const crcea_context *cc, uint64_t window, crcea_int crc)
+{
+    crcea_alloc_f *alloc = cc->alloc;
+    size_t size = 0;
+
+    if (!alloc) {
+#ifdef CRCEA_DEFAULT_MALLOC
+        alloc = CRCEA_DEFAULT_MALLOC;
+#else
+        return 1;
+#endif
+    }
+
+#define CRCEA_ROLLING_TABLESIZE(T, P) size = sizeof(T[2][256])
+
+    CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_ROLLING_TABLESIZE);
+
+    void *table = alloc(cc->opaque, size);
+    if (!table) {
+        return 1;
+    }
+
+#define CRCEA_ROLLING_SETUP(T, P)                                           \
+    do {                                                                    \
+        T base, unshift;                                                    \
+        P ## _rolling_build_table(cc->design, window, table);               \
+        P ## _rolling_setup(cc->design, window, crc, &base, &unshift);      \
+        rc->base = base;                                                    \
+        rc->unshift = unshift;                                              \
+    } while (0)                                                             \
+
+    CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_ROLLING_SETUP);
+
+    rc->context = cc;
+    rc->table = table;
+    rc->state = 0;
+
+    return 0;
+}
+
+/*
+ * crcea_rolling_setup() で確保したテーブルを、確保した方法で解放する。
+ *
+ * cc は crcea_rolling_setup() に与えたものと同じ設定であること。
+ * cc->alloc で確保したテーブルは cc->free が NULL であれば解放されない。
+ */
+void
+crcea_rolling_release(crcea_rolling *rc, const crcea_context *cc)
+{
+    void *table = (void *)rc->table;
+
+    rc->table = NULL;
+
+    if (!table) {
+        return;
+    }
+
+    if (cc->alloc) {
+        if (cc->free) {
+            (*cc->free)(cc->opaque, table);
+        }
+    } else {
+#ifdef CRCEA_DEFAULT_FREE
+        CRCEA_DEFAULT_FREE(cc->opaque, table);
+#endif
+    }
+}
+
+crcea_int
+crcea_rolling_roll(crcea_rolling *rc, int out, int in)
+{
+#define CRCEA_ROLLING_ROLL(T, P)                                            \
+    do {                                                                    \
+        return rc->state = P ## _rolling_roll(rc->context->design, rc->table, rc->state, out, in); \
+    } while (0)                                                             \
+
+    CRCEA_SWITCH_BY_TYPE(rc->context->design, CRCEA_ROLLING_ROLL);
+
+    return rc->state;
+}
+
+crcea_int
+crcea_rolling_crc(const crcea_rolling *rc)
+{
+#define CRCEA_ROLLING_CRC(T, P) return P ## _rolling_crc(rc->context->design, rc->base, rc->unshift, rc->state)
+
+    CRCEA_SWITCH_BY_TYPE(rc->context->design, CRCEA_ROLLING_CRC);
+
+    return ~(crcea_int)0;
+}
+
+/*
+ * cc のアルゴリズムとテーブルを確定させ、型の幅とアルゴリズムを解決した関数を compiled に設定する。
+ *
+ * 返り値は crcea_prepare_table() と同じ。
+ */
+int
+crcea_compile(crcea_context *cc, crcea_compiled *compiled)
+{
+    int algo = crcea_prepare_table(cc);
+
+    compiled->design = cc->design;
+    compiled->algorithm = algo;
+    compiled->table = cc->table;
+
+#define CRCEA_COMPILE(T, P)                                                 \
+    do {                                                                    \
+        compiled->setup = P ## _compiled_setup;                             \
+        compiled->update = P ## _compile_update(cc->design, algo, cc->table); \
+        compiled->finish = P ## _compiled_finish;                           \
+    } while (0)                                                             \
+
+    CRCEA_SWITCH_BY_TYPE(cc->design, CRCEA_COMPILE);
+
+    return algo;
+}
+
+int
+crcea_length_class(size_t len)
+{
+    if (len <= 64) {
+        return CRCEA_LENGTH_TINY;
+    } else if (len <= 1024) {
+        return CRCEA_LENGTH_SMALL;
+    } else if (len <= 65536) {
+        return CRCEA_LENGTH_MEDIUM;
+    } else {
+        return CRCEA_LENGTH_LARGE;
+    }
+}
+
+#define CRCEA_AUTOTUNE_INPUTSIZE (1 << 18)
+#define CRCEA_AUTOTUNE_ROUNDS 3
+
+/*
+ * crcea_autotune() で計測するアルゴリズム。
+ *
+ * ビット単位のものと、CRCEA_BY8_SEXDECTET 以上の大きなテーブルのものは除いている。
+ */
+static const int16_t crcea_autotune_candidates[] = {
+    CRCEA_FALLBACK,
+    CRCEA_BY4_QUARTET,
+    CRCEA_BY8_QUARTET,
+    CRCEA_BY1_OCTET,
+    CRCEA_BY4_OCTET,
+    CRCEA_BY8_OCTET,
+    CRCEA_BY16_OCTET,
+    CRCEA_BY32_OCTET,
+    CRCEA_BY8_OCTET_2WAY,
+    CRCEA_BY2_SEXDECTET,
+    CRCEA_BY4_SEXDECTET,
+    CRCEA_CLMUL_FOLD,
+    CRCEA_VPCLMUL_FOLD,
+    CRCEA_SSE42_CRC32C,
+};
+
+/*
+ * 区分ごとの代表的な長さ
+ */
+static const size_t crcea_autotune_lengths[CRCEA_LENGTH_CLASSES] = { 64, 1024, 65536, CRCEA_AUTOTUNE_INPUTSIZE };
+
+static uint64_t
+crcea_autotune_clock(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#else
+    return (uint64_t)clock() * (1000000000u / CLOCKS_PER_SEC);
+#endif
+}
+
+/*
+ * cc で len バイトずつ input を一巡する時間の最小値を返す
+ */
+static uint64_t
+crcea_autotune_measure(const crcea_context *cc, const char *input, size_t len)
+{
+    uint64_t best = ~(uint64_t)0;
+    crcea_int s = 0;
+
+    for (int round = 0; round < CRCEA_AUTOTUNE_ROUNDS; round ++) {
+        uint64_t t = crcea_autotune_clock();
+        for (size_t off = 0; off + len <= CRCEA_AUTOTUNE_INPUTSIZE; off += len) {
+            s = crcea_update(cc, input + off, input + off + len, s);
+        }
+        t = crcea_autotune_clock() - t;
+        if (t < best) { best = t; }
+    }
+
+    /* 計算を省かれないように結果を使う */
+    if (s == 1) { best ++; }
+
+    return best;
+}
+
+/*
+ * 有効化されているアルゴリズムを入力の長さの区分ごとに計測する。
+ *
+ * tuning が NULL でなければ区分ごとに最も速かったアルゴリズムを記録する。
+ * cc->algorithm は flags で示された区分の時間を、それぞれの区分で最も速い時間との比で合計して最も小さいアルゴリズムとし、
+ * テーブルを用意し直す。flags が 0 であれば CRCEA_AUTOTUNE_ALL とみなす。
+ *
+ * 計測用の入力とテーブルは既定のアロケータで確保し、
+ * 既定のアロケータがなければ cc->alloc で確保する。
+ * 確保したものを返す手段がない (cc->alloc を用いるが cc->free が NULL である) 場合や、
+ * 計測用の入力を確保できなければ、何もせずに cc->algorithm を返す。
+ */
+int
+crcea_autotune(crcea_context *cc, int flags, crcea_tuning *tuning)
+{
+    enum { n = sizeof(crcea_autotune_candidates) / sizeof(crcea_autotune_candidates[0]) };
+    uint64_t time[n][CRCEA_LENGTH_CLASSES];
+    uint64_t best[CRCEA_LENGTH_CLASSES];
+    int16_t winner[CRCEA_LENGTH_CLASSES];
+    crcea_alloc_f *alloc = cc->alloc;
+    crcea_free_f *dealloc = cc->free;
+    char *input;
+
+    if ((flags & CRCEA_AUTOTUNE_ALL) == 0) {
+        flags |= CRCEA_AUTOTUNE_ALL;
+    }
+
+#ifdef CRCEA_DEFAULT_MALLOC
+    alloc = CRCEA_DEFAULT_MALLOC;
+# ifdef CRCEA_DEFAULT_FREE
+    dealloc = CRCEA_DEFAULT_FREE;
+# else
+    dealloc = NULL;
+# endif
+#endif
+
+    /* 計測用の入力と候補ごとのテーブルを解放できなければ、arena などを使い潰してしまう */
+    if (!alloc || !dealloc || !(input = (char *)alloc(cc->opaque, CRCEA_AUTOTUNE_INPUTSIZE))) {
+        return cc->algorithm;
+    }
+
+    uint64_t x = 88172645463325252ull;
+    for (size_t i = 0; i < CRCEA_AUTOTUNE_INPUTSIZE; i ++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        input[i] = (char)(x >> 32);
+    }
+
+    for (int k = 0; k < CRCEA_LENGTH_CLASSES; k ++) {
+        best[k] = ~(uint64_t)0;
+        winner[k] = CRCEA_FALLBACK;
+    }
+
+    for (int i = 0; i < n; i ++) {
+        crcea_context c = *cc;
+        c.algorithm = crcea_autotune_candidates[i];
+        c.table = NULL;
+#ifdef CRCEA_DEFAULT_MALLOC
+        /* 計測のためのテーブルで cc->alloc の領域を消費しないように、共有テーブルを用いる */
+        c.alloc = NULL;
+        c.free = NULL;
+#endif
+        c.adaptive = NULL;
+
+        if (c.algorithm >= CRCEA_TABLE_ALGORITHM &&
+            (crcea_tablesize(&c) == 0 || crcea_prepare_table(&c) != c.algorithm)) {
+            /* 有効化されていないか、テーブルを用意できない */
+            crcea_release_table(&c);
+            for (int k = 0; k < CRCEA_LENGTH_CLASSES; k ++) { time[i][k] = ~(uint64_t)0; }
+            continue;
+        }
+
+        for (int k = 0; k < CRCEA_LENGTH_CLASSES; k ++) {
+            time[i][k] = crcea_autotune_measure(&c, input, crcea_autotune_lengths[k]);
+            if (time[i][k] < best[k]) {
+                best[k] = time[i][k];
+                winner[k] = c.algorithm;
+            }
+        }
+
+        crcea_release_table(&c);
+    }
+
+    dealloc(cc->opaque, input);
+
+    int algo = CRCEA_FALLBACK;
+    double score = 0;
+
+    for (int i = 0; i < n; i ++) {
+        double sum = 0;
+
+        for (int k = 0; k < CRCEA_LENGTH_CLASSES; k ++) {
+            if (flags & (1 << k)) {
+                sum += (double)time[i][k] / (double)(best[k] > 0 ? best[k] : 1);
+            }
+        }
+
+        if (i == 0 || sum < score) {
+            score = sum;
+            algo = crcea_autotune_candidates[i];
+        }
+    }
+
+    if (tuning) {
+        tuning->version = CRCEA_TUNING_VERSION;
+        tuning->cpu = crcea_cpu_features();
+        for (int k = 0; k < CRCEA_LENGTH_CLASSES; k ++) {
+            tuning->algorithm[k] = winner[k];
+        }
+    }
+
+    if (cc->algorithm != algo) {
+        crcea_release_table(cc);
+        cc->algorithm = algo;
+    }
+
+    return crcea_prepare_table(cc);
+}
+
+/*
+ * crcea_autotune() が記録した tuning から、入力の長さの区分 lengthclass のアルゴリズムを cc->algorithm に設定し、
+ * テーブルを用意し直す。
+ *
+ * tuning の version が CRCEA_TUNING_VERSION と異なるか、cpu が実行中の CPU の crcea_cpu_features() と異なるか、
+ * アルゴリズムがこのライブラリで計測の対象とならないものであれば、tuning は用いずに CRCEA_AUTOMATIC とする。
+ * 戻り値は crcea_prepare_table() と同じ。
+ */
+int
+crcea_tuning_apply(crcea_context *cc, const crcea_tuning *tuning, int lengthclass)
+{
+    int algo = CRCEA_AUTOMATIC;
+
+    if (tuning && tuning->version == CRCEA_TUNING_VERSION && tuning->cpu == crcea_cpu_features() &&
+        lengthclass >= 0 && lengthclass < CRCEA_LENGTH_CLASSES) {
+        for (size_t i = 0; i < sizeof(crcea_autotune_candidates) / sizeof(crcea_autotune_candidates[0]); i ++) {
+            if (tuning->algorithm[lengthclass] == crcea_autotune_candidates[i]) {
+                algo = crcea_autotune_candidates[i];
+                break;
+            }
+        }
+    }
+
+    if (algo >= CRCEA_TABLE_ALGORITHM && algo != CRCEA_AUTOMATIC) {
+        crcea_context c = *cc;
+        c.algorithm = algo;
+        if (crcea_tablesize(&c) == 0) {
+            /* 有効化されていない */
+            algo = CRCEA_AUTOMATIC;
+        }
+    }
+
+    if (cc->algorithm != algo) {
+        crcea_release_table(cc);
+        cc->algorithm = algo;
+    }
+
+    return crcea_prepare_table(cc);
+}
+
 #ifndef CRCEA_NO_MALLOC
 static void *
 CRCEA_DEFAULT_MALLOC(void *opaque, size_t size)
@@ -198,4 +1314,12 @@ CRCEA_DEFAULT_MALLOC(void *opaque, size_t size)
 
     return CRCEA_MALLOC(size);
 }
+
+static void
+CRCEA_DEFAULT_FREE(void *opaque, void *ptr)
+{
+    (void)opaque;
+
+    CRCEA_FREE(ptr);
+}
 #endif
@@ -4,8 +4,11 @@
  * license:: Creative Commons Zero License (CC0 / Public Domain)
  */
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "../include/crcea.h"
 
@@ -35,6 +38,76 @@ xor64(void)
     return x;
 }
 
+static void *
+test_alloc(void *opaque, size_t size)
+{
+    (void)opaque;
+
+    return malloc(size);
+}
+
+static void
+test_free(void *opaque, void *ptr)
+{
+    (void)opaque;
+
+    free(ptr);
+}
+
+static void *
+count_alloc(void *opaque, size_t size)
+{
+    ++ *(int *)opaque;
+
+    return malloc(size);
+}
+
+static void
+count_free(void *opaque, void *ptr)
+{
+    -- *(int *)opaque;
+
+    free(ptr);
+}
+
+static void
+print_int(crcea_int n, int digits)
+{
+    if (digits > 16) {
+        fprintf(stdout, "%0*lx%016lx", digits - 16, (unsigned long)(n >> 32 >> 32), (unsigned long)(uint64_t)n);
+    } else {
+        fprintf(stdout, "%0*lx", digits, (unsigned long)n);
+    }
+}
+
+/*
+ * 設計と期待値、実際の値を表示して 1 を返す。what 以降は printf() と同じ書式。
+ */
+static int
+report_failure(const crcea_design *design, crcea_int expect, crcea_int actual, const char *what, ...)
+{
+    const int digits = (design->bitsize + 3) / 4;
+    va_list args;
+
+    fprintf(stdout, "CRC-%02d-0x", design->bitsize);
+    print_int(design->polynomial & (~(crcea_int)0 >> (sizeof(crcea_int) * 8 - design->bitsize)), digits);
+    fprintf(stdout, " (%c%c%c), expect 0x",
+            (design->reflectin ? 'i' : '-'),
+            (design->reflectout ? 'o' : '-'),
+            (design->appendzero ? 'z' : '-'));
+    print_int(expect, digits);
+    fprintf(stdout, ", actual 0x");
+    print_int(actual, digits);
+    fprintf(stdout, " (");
+    va_start(args, what);
+    vfprintf(stdout, what, args);
+    va_end(args);
+    fprintf(stdout, ") - FAILED\n");
+
+    return 1;
+}
+
+
 static const char *
 lookup_algorithm_name(int algo)
 {
@@ -78,11 +151,16 @@ lookup_algorithm_name(int algo)
     CASE_TO_STRING(CRCEA_BY8_OCTET);
     CASE_TO_STRING(CRCEA_BY16_OCTET);
     CASE_TO_STRING(CRCEA_BY32_OCTET);
+    CASE_TO_STRING(CRCEA_BY8_OCTET_2WAY);
     CASE_TO_STRING(CRCEA_BY2_SEXDECTET);
     CASE_TO_STRING(CRCEA_BY4_SEXDECTET);
     CASE_TO_STRING(CRCEA_BY8_SEXDECTET);
     CASE_TO_STRING(CRCEA_BY16_SEXDECTET);
     CASE_TO_STRING(CRCEA_BY32_SEXDECTET);
+    CASE_TO_STRING(CRCEA_CLMUL_FOLD);
+    CASE_TO_STRING(CRCEA_VPCLMUL_FOLD);
+    CASE_TO_STRING(CRCEA_SSE42_CRC32C);
+    CASE_TO_STRING(CRCEA_AUTOMATIC);
     default: return "unknown (test code bug)";
     }
 }
@@ -96,16 +174,23 @@ main(int argc, char *argv[])
 
     int bad = 0;
 
-    char seq[191];
+    if (crcea_abi_version() != CRCEA_ABI_VERSION) {
+        fprintf(stdout, "crcea_abi_version() is %d, expect %d - FAILED\n", crcea_abi_version(), CRCEA_ABI_VERSION);
+        bad = 1;
+    }
+
+    char seq[4099];
     for (unsigned int i = 0; i < sizeof(seq); i ++) {
         seq[i] = xor64() >> 13;
     }
 
-    FOREACH_LIST(int, bitsize, 3, 5, 8, 13, 16, 21, 29, 32, 41) {
+    static const char zero[1000] = { 0 };
+
+    FOREACH_LIST(int, bitsize, 3, 5, 8, 13, 16, 21, 29, 32, 41, 63, 64) {
         FOREACH_LIST(int, refin, 0, 1) {
             FOREACH_LIST(int, refout, 0, 1) {
                 FOREACH_LIST(int, append, 0, 1) {
-                    FOREACH_LIST(uint32_t, poly, 0x04C11DB7ul, 0x1EDC6F41ul) {
+                    FOREACH_LIST(uint64_t, poly, 0x04C11DB7ul, 0x1EDC6F41ul, 0x42F0E1EBA9EA3693ull) {
                         const crcea_design design = {
                             .bitsize = *bitsize,
                             .polynomial = *poly,
@@ -122,7 +207,161 @@ main(int argc, char *argv[])
                             .alloc = NULL,
                         };
 
-                        uint64_t r = crcea(&ref, seq, seq + sizeof(seq), 0);
+                        crcea_int r = crcea(&ref, seq, seq + sizeof(seq), 0);
+
+                        FOREACH_LIST(int, threads, 0, 2, 3, 8) {
+                            crcea_int t = crcea_update_parallel(&ref, seq, seq + sizeof(seq), crcea_setup(&ref, 0), *threads);
+                            crcea_int s = crcea_finish(&ref, t);
+                            if (r != s) {
+                                bad = report_failure(&design, r, s, "crcea_update_parallel with %d", *threads);
+                            }
+                        }
+
+                        {
+                            /* テーブルは crcea_update_parallel() の中で用意される */
+                            crcea_context cc = {
+                                .design = &design,
+                                .algorithm = CRCEA_BY8_OCTET,
+                                .table = NULL,
+                                .alloc = NULL,
+                            };
+
+                            crcea_int t = crcea_update_parallel(&cc, seq, seq + sizeof(seq), crcea_setup(&cc, 0), 4);
+                            crcea_int s = crcea_finish(&cc, t);
+                            if (r != s || !cc.table) {
+                                bad = report_failure(&design, r, s, "crcea_update_parallel without the table");
+                            }
+
+                            crcea_release_table(&cc);
+                        }
+
+                        FOREACH_LIST(size_t, off, 0, 1, 7, 100, sizeof(seq) - 3, sizeof(seq)) {
+                            crcea_int a = crcea(&ref, seq, seq + *off, 0);
+                            crcea_int b = crcea(&ref, seq + *off, seq + sizeof(seq), 0);
+                            crcea_int s = crcea_combine(&ref, a, b, sizeof(seq) - *off);
+                            if (r != s) {
+                                bad = report_failure(&design, r, s, "crcea_combine at %d", (int)*off);
+                            }
+                        }
+
+                        FOREACH_LIST(size_t, times, 0, 1, 2, 3, 1365) {
+                            char fill[3 * 1365];
+                            for (size_t i = 0; i < *times * 3; i ++) {
+                                fill[i] = seq[i % 3];
+                            }
+
+                            crcea_int t = crcea_update(&ref, seq, seq + 100, crcea_setup(&ref, 0));
+                            crcea_int a = crcea_finish(&ref, crcea_update(&ref, fill, fill + *times * 3, t));
+                            crcea_int f = crcea_finish(&ref, crcea_update_repeat(&ref, seq, seq + 3, *times, t));
+                            if (a != f) {
+                                bad = report_failure(&design, a, f, "crcea_update_repeat by %d", (int)*times);
+                            }
+                        }
+
+                        FOREACH_LIST(size_t, off, 0, 1, 7, 100, sizeof(seq) - 3, sizeof(seq)) {
+                            crcea_int t = crcea_update(&ref, seq, seq + sizeof(seq), crcea_setup(&ref, 0));
+                            crcea_int a = crcea(&ref, seq, seq + *off, 0);
+                            crcea_int u = crcea_finish(&ref, crcea_unupdate(&ref, seq + *off, seq + sizeof(seq), t));
+                            if (a != u) {
+                                bad = report_failure(&design, a, u, "crcea_unupdate at %d", (int)*off);
+                            }
+                        }
+
+                        FOREACH_LIST(size_t, off, 0, 1, 100, sizeof(seq) - 300) {
+                            char mod[sizeof(seq)];
+                            memcpy(mod, seq, sizeof(seq));
+                            for (size_t i = 0; i < 300; i ++) {
+                                mod[*off + i] = (char)(mod[*off + i] * 7 + i);
+                            }
+
+                            crcea_int a = crcea(&ref, mod, mod + sizeof(mod), 0);
+                            crcea_int p = crcea_patch(&ref, r, sizeof(seq), *off, seq + *off, mod + *off, 300);
+                            if (a != p) {
+                                bad = report_failure(&design, a, p, "crcea_patch at %d", (int)*off);
+                            }
+                        }
+
+                        {
+                            crcea_rolling roll;
+                            crcea_rolling_setup(&roll, &ref, 100, 0);
+                            for (size_t i = 0; i < sizeof(seq); i ++) {
+                                crcea_rolling_roll(&roll, (i < 100 ? 0 : seq[i - 100]), seq[i]);
+                                if (i + 1 == 100 || i + 1 == 101 || i + 1 == 1000 || i + 1 == sizeof(seq)) {
+                                    crcea_int a = crcea(&ref, seq + i + 1 - 100, seq + i + 1, 0);
+                                    crcea_int w = crcea_rolling_crc(&roll);
+                                    if (a != w) {
+                                        bad = report_failure(&design, a, w, "crcea_rolling at %d", (int)i + 1);
+                                    }
+                                }
+                            }
+                            crcea_rolling_release(&roll, &ref);
+                        }
+
+                        {
+                            /* 個別に解放できない arena から確保した場合は、解放せずにテーブルを外す */
+                            static char buffer[sizeof(crcea_int[2][256]) + CRCEA_TABLE_ALIGNMENT];
+                            crcea_arena arena = { .buffer = buffer, .size = sizeof(buffer), .used = 0 };
+                            crcea_context cc = ref;
+                            cc.alloc = crcea_arena_alloc;
+                            cc.free = NULL;
+                            cc.opaque = &arena;
+
+                            crcea_rolling roll;
+                            if (crcea_rolling_setup(&roll, &cc, 100, 0) != 0) {
+                                bad = report_failure(&design, 0, 0, "crcea_rolling_setup with crcea_arena");
+                            } else {
+                                crcea_rolling_roll(&roll, 0, seq[0]);
+                                crcea_rolling_release(&roll, &cc);
+                                if (roll.table) {
+                                    bad = report_failure(&design, 0, 0, "crcea_rolling_release with crcea_arena");
+                                }
+                            }
+                        }
+
+                        FOREACH_LIST(size_t, len, 0, 1, 7, 100, sizeof(zero)) {
+                            crcea_int t = crcea_update(&ref, seq, seq + 100, crcea_setup(&ref, 0));
+                            crcea_int a = crcea_finish(&ref, crcea_update(&ref, zero, zero + *len, t));
+                            crcea_int z = crcea_finish(&ref, crcea_update_zeros(&ref, *len, t));
+                            if (a != z) {
+                                bad = report_failure(&design, a, z, "crcea_update_zeros by %d", (int)*len);
+                            }
+                        }
+
+                        {
+                            crcea_context shared[2] = {
+                                { .design = &design, .algorithm = CRCEA_BY1_OCTET, .table = NULL, .alloc = NULL, },
+                                { .design = &design, .algorithm = CRCEA_BY1_OCTET, .table = NULL, .alloc = NULL, },
+                            };
+
+                            crcea_prepare_table(&shared[0]);
+                            crcea_prepare_table(&shared[1]);
+                            crcea_int s = crcea(&shared[1], seq, seq + sizeof(seq), 0);
+                            if (shared[0].table == NULL || shared[0].table != shared[1].table || r != s) {
+                                bad = report_failure(&design, r, s, "shared table %p and %p", shared[0].table, shared[1].table);
+                            }
+
+                            crcea_release_table(&shared[0]);
+                            crcea_release_table(&shared[1]);
+                        }
+
+                        {
+                            static char buffer[sizeof(uint64_t[4][256]) + CRCEA_TABLE_ALIGNMENT];
+                            crcea_arena arena = { .buffer = buffer + 1, .size = sizeof(buffer) - 1, .used = 0, };
+                            crcea_context bbb = {
+                                .design = &design,
+                                .algorithm = CRCEA_BY4_OCTET,
+                                .table = NULL,
+                                .alloc = crcea_arena_alloc,
+                                .opaque = &arena,
+                            };
+
+                            crcea_prepare_table(&bbb);
+                            crcea_int s = crcea(&bbb, seq, seq + sizeof(seq), 0);
+                            if (bbb.table == NULL || (uintptr_t)bbb.table % CRCEA_TABLE_ALIGNMENT != 0 || r != s) {
+                                bad = report_failure(&design, r, s, "crcea_arena_alloc at %p", bbb.table);
+                            }
+                            crcea_release_table(&bbb);
+                        }
 
                         FOREACH_LIST(int, algo,
                                      CRCEA_FALLBACK,
@@ -162,28 +401,72 @@ main(int argc, char *argv[])
                                      CRCEA_BY8_OCTET,
                                      CRCEA_BY16_OCTET,
                                      CRCEA_BY32_OCTET,
+                                     CRCEA_BY8_OCTET_2WAY,
                                      CRCEA_BY2_SEXDECTET,
                                      CRCEA_BY4_SEXDECTET,
                                      CRCEA_BY8_SEXDECTET,
                                      CRCEA_BY16_SEXDECTET,
-                                     CRCEA_BY32_SEXDECTET) {
+                                     CRCEA_BY32_SEXDECTET,
+                                     CRCEA_CLMUL_FOLD,
+                                     CRCEA_VPCLMUL_FOLD,
+                                     CRCEA_SSE42_CRC32C,
+                                     CRCEA_AUTOMATIC) {
                             crcea_context bbb = {
                                 .design = &design,
                                 .algorithm = *algo,
                                 .table = NULL,
-                                .alloc = NULL,
+                                .alloc = test_alloc,
+                                .free = test_free,
                             };
 
-                            uint64_t s = crcea(&bbb, seq, seq + sizeof(seq), 0);
+                            crcea_compiled cp;
+                            crcea_compile(&bbb, &cp);
+                            crcea_int s = crcea(&bbb, seq, seq + sizeof(seq), 0);
+                            crcea_int c = cp.finish(cp.design, cp.update(&cp, seq, seq + sizeof(seq), cp.setup(cp.design, 0)));
+                            crcea_int t = crcea_setup(&bbb, 0);
+                            for (size_t i = 0, n = 0; i < sizeof(seq); i += n) {
+                                static const size_t chunks[] = { 1, 2, 3, 5, 8, 13, 21, 34 };
+                                n = chunks[(i * 7) % ELEMENTOF(chunks)];
+                                if (n > sizeof(seq) - i) { n = sizeof(seq) - i; }
+                                t = crcea_update(&bbb, seq + i, seq + i + n, t);
+                            }
+                            crcea_int u = crcea_finish(&bbb, t);
+
+                            crcea_iovec iov[64];
+                            size_t iovcnt = 0;
+                            for (size_t i = 0, n = 0; i < sizeof(seq); i += n, iovcnt ++) {
+                                static const size_t segments[] = { 1, 60, 64, 7, 130, 3, 0, 200 };
+                                n = segments[iovcnt % ELEMENTOF(segments)];
+                                if (n > sizeof(seq) - i || iovcnt == ELEMENTOF(iov) - 1) { n = sizeof(seq) - i; }
+                                iov[iovcnt].base = seq + i;
+                                iov[iovcnt].len = n;
+                            }
+                            crcea_int v = crcea_finish(&bbb, crcea_updatev(&bbb, iov, iovcnt, crcea_setup(&bbb, 0)));
+                            if (r != v) {
+                                bad = report_failure(&design, r, v, "%s by crcea_updatev", lookup_algorithm_name(*algo));
+                            }
+                            FOREACH_LIST(size_t, bytes, 0, 5, 100) {
+                                for (int rest = 1; rest < 8; rest ++) {
+                                    char msg[101];
+                                    memcpy(msg, seq, *bytes + 1);
+                                    msg[*bytes] &= (design.reflectin ? 0xff >> (8 - rest) : 0xff00 >> rest);
+                                    crcea_int w0 = crcea(&ref, msg, msg + *bytes + 1, 0);
+                                    crcea_int st = crcea_update_bits(&bbb, seq, *bytes * 8 + rest, crcea_setup(&bbb, 0));
+                                    crcea_int w = crcea_finish(&bbb, crcea_update_bits(&bbb, zero, 8 - rest, st));
+                                    if (w0 != w) {
+                                        bad = report_failure(&design, w0, w, "%s by crcea_update_bits with %d", lookup_algorithm_name(*algo), (int)(*bytes * 8 + rest));
+                                    }
+                                }
+                            }
+                            crcea_release_table(&bbb);
+                            if (r != u) {
+                                bad = report_failure(&design, r, u, "%s by chunks", lookup_algorithm_name(*algo));
+                            }
+                            if (r != c) {
+                                bad = report_failure(&design, r, c, "%s by crcea_compile", lookup_algorithm_name(*algo));
+                            }
                             if (r != s) {
-                                bad = 1;
-                                fprintf(stdout, "CRC-%02d-0x%08x (%c%c%c), expect 0x%016lx, actual 0x%016lx (%s) - %s\n",
-                                        *bitsize, (uint32_t)design.polynomial & ~(~0 << 1 << (design.bitsize - 1)),
-                                        (design.reflectin ? 'i' : '-'),
-                                        (design.reflectout ? 'o' : '-'),
-                                        (design.appendzero ? 'z' : '-'),
-                                        r, s, (r == s ? "OK" : "FAILED"),
-                                        lookup_algorithm_name(*algo));
+                                bad = report_failure(&design, r, s, "%s", lookup_algorithm_name(*algo));
                             }
                         }
                     }
@@ -192,6 +475,299 @@ main(int argc, char *argv[])
         }
     }
 
+    /* CRC-16/XMODEM の生成多項式で appendzero が偽の設計を、短いパケットごとに計算する */
+    FOREACH_LIST(int, bitsize, 12, 16) {
+        FOREACH_LIST(int, refin, 0, 1) {
+            const crcea_design design = {
+                .bitsize = *bitsize,
+                .polynomial = 0x1021,
+                .reflectin = *refin,
+                .reflectout = *refin,
+                .appendzero = 0,
+                .xoroutput = 0,
+            };
+
+            crcea_context ref = {
+                .design = &design,
+                .algorithm = CRCEA_REFERENCE,
+                .table = NULL,
+                .alloc = NULL,
+            };
+
+            FOREACH_LIST(int, algo,
+                         CRCEA_FALLBACK,
+                         CRCEA_BITWISE_BRANCHLESS,
+                         CRCEA_BY4_QUARTET,
+                         CRCEA_BY1_OCTET,
+                         CRCEA_BY8_OCTET,
+                         CRCEA_BY16_SEXDECTET,
+                         CRCEA_CLMUL_FOLD) {
+                crcea_context cc = {
+                    .design = &design,
+                    .algorithm = *algo,
+                    .table = NULL,
+                    .alloc = NULL,
+                };
+
+                crcea_prepare_table(&cc);
+
+                crcea_int t = crcea_setup(&ref, 0), u = crcea_setup(&cc, 0);
+                for (size_t len = 0, off = 0; len <= 40; off += len, len ++) {
+                    crcea_int r = crcea(&ref, seq + off, seq + off + len, 0);
+                    crcea_int s = crcea(&cc, seq + off, seq + off + len, 0);
+                    if (r != s) {
+                        bad = report_failure(&design, r, s, "%s with a packet of %d bytes", lookup_algorithm_name(*algo), (int)len);
+                    }
+
+                    t = crcea_update(&ref, seq + off, seq + off + len, t);
+                    u = crcea_update(&cc, seq + off, seq + off + len, u);
+                    if (t != u) {
+                        bad = report_failure(&design, crcea_finish(&ref, t), crcea_finish(&cc, u), "%s after a packet of %d bytes", lookup_algorithm_name(*algo), (int)len);
+                    }
+                }
+
+                crcea_release_table(&cc);
+            }
+        }
+    }
+
+    {
+        static const crcea_design crc32 = {
+            .bitsize = 32,
+            .polynomial = 0x04C11DB7ul,
+            .reflectin = 1,
+            .reflectout = 1,
+            .appendzero = 1,
+            .xoroutput = ~0ul,
+        };
+
+        crcea_context cc = {
+            .design = &crc32,
+            .algorithm = CRCEA_AUTOMATIC,
+            .table = NULL,
+            .alloc = NULL,
+        };
+
+        crcea_tuning tuning;
+        int algo = crcea_autotune(&cc, CRCEA_AUTOTUNE_SMALL | CRCEA_AUTOTUNE_LARGE, &tuning);
+        crcea_int s = crcea(&cc, "123456789", "123456789" + 9, 0);
+        if (algo != cc.algorithm || s != 0xcbf43926ul) {
+            bad = report_failure(&crc32, 0xcbf43926ul, s, "crcea_autotune to %s", lookup_algorithm_name(algo));
+        }
+
+        /* 版や CPU が異なる記録や、知らないアルゴリズムは用いられない */
+        int automatic = crcea_select_algorithm(&crc32, CRCEA_AUTOMATIC);
+        FOREACH_LIST(int, broken, 0, 1, 2, 3) {
+            crcea_tuning t = tuning;
+            t.algorithm[CRCEA_LENGTH_MEDIUM] = CRCEA_BY4_QUARTET;
+            if (*broken == 1) { t.version ++; }
+            if (*broken == 2) { t.cpu = ~t.cpu; }
+            if (*broken == 3) { t.algorithm[CRCEA_LENGTH_MEDIUM] = 0x7ffe; }
+            int expect = (*broken == 0 ? CRCEA_BY4_QUARTET : automatic);
+            algo = crcea_tuning_apply(&cc, &t, CRCEA_LENGTH_MEDIUM);
+            s = crcea(&cc, "123456789", "123456789" + 9, 0);
+            if (algo != expect || s != 0xcbf43926ul) {
+                bad = report_failure(&crc32, 0xcbf43926ul, s, "crcea_tuning_apply (broken %d) to %s", *broken, lookup_algorithm_name(algo));
+            }
+        }
+
+        crcea_release_table(&cc);
+    }
+
+    {
+        static const crcea_design crc32 = {
+            .bitsize = 32,
+            .polynomial = 0x04C11DB7ul,
+            .reflectin = 1,
+            .reflectout = 1,
+            .appendzero = 1,
+            .xoroutput = ~0ul,
+        };
+
+        crcea_context cc = {
+            .design = &crc32,
+            .algorithm = CRCEA_BY1_OCTET,
+            .table = NULL,
+            .alloc = NULL,
+        };
+
+        crcea_adaptive adaptive;
+        crcea_adaptive_setup(&cc, &adaptive, CRCEA_BY4_QUARTET, CRCEA_BY16_OCTET, 16);
+
+        int current[2];
+        FOREACH_LIST(size_t, len, 9, 4096) {
+            for (int i = 0; i < 64; i ++) {
+                crcea_int s = crcea(&cc, "123456789", "123456789" + 9, 0);
+                if (*len > 9) {
+                    crcea(&cc, seq, seq + *len, 0);
+                }
+                if (s != 0xcbf43926ul) {
+                    bad = report_failure(&crc32, 0xcbf43926ul, s, "crcea_adaptive_setup with %s", lookup_algorithm_name(adaptive.algorithm[adaptive.current]));
+                    break;
+                }
+            }
+            current[*len > 9] = adaptive.current;
+        }
+
+        if (current[0] != 0 || current[1] != 1) {
+            bad = 1;
+            fprintf(stdout, "CRC-32, expect 0 and 1, actual %d and %d (crcea_adaptive switching) - FAILED\n",
+                    current[0], current[1]);
+        }
+        crcea_release_table(&cc);
+    }
+
+    {
+        static const crcea_design crc32 = {
+            .bitsize = 32,
+            .polynomial = 0x04c11db7ul,
+            .reflectin = 1,
+            .reflectout = 1,
+            .appendzero = 1,
+            .xoroutput = ~0ul,
+        };
+
+        int live = 0;
+        crcea_context cc = {
+            .design = &crc32,
+            .algorithm = CRCEA_BY1_OCTET,
+            .alloc = count_alloc,
+            .free = count_free,
+            .opaque = &live,
+        };
+
+        crcea_adaptive adaptive;
+        crcea_adaptive_setup(&cc, &adaptive, CRCEA_BY4_QUARTET, CRCEA_BY16_OCTET, 16);
+        crcea_adaptive_setup(&cc, &adaptive, CRCEA_BY8_QUARTET, CRCEA_BY8_OCTET, 16);
+
+        crcea_int s = crcea(&cc, "123456789", "123456789" + 9, 0);
+        if (s != 0xcbf43926ul) {
+            bad = report_failure(&crc32, 0xcbf43926ul, s, "crcea_adaptive_setup twice");
+        }
+
+        crcea_release_table(&cc);
+        if (live != 0) {
+            bad = 1;
+            fprintf(stdout, "CRC-32, expect 0, actual %d tables left (crcea_adaptive_setup twice) - FAILED\n", live);
+        }
+    }
+
+#ifdef CRCEA_ENABLE_INT128
+    {
+        static const crcea_design crc82darc = {
+            .bitsize = 82,
+            .polynomial = ((crcea_int)0x308c << 64) | 0x0111011401440411ull,
+            .reflectin = 1,
+            .reflectout = 1,
+            .appendzero = 1,
+            .xoroutput = 0,
+        };
+
+        const crcea_int check = ((crcea_int)0x09ea8 << 64) | 0x3f625023801fd612ull;
+
+        FOREACH_LIST(int, bitsize, 65, 82, 128) {
+            FOREACH_LIST(int, refin, 0, 1) {
+                FOREACH_LIST(int, append, 0, 1) {
+                    const crcea_design design = {
+                        .bitsize = *bitsize,
+                        .polynomial = crc82darc.polynomial | ((crcea_int)0xa5 << 72) | 0x80,
+                        .reflectin = *refin,
+                        .reflectout = *refin,
+                        .appendzero = *append,
+                        .xoroutput = ~(crcea_int)0,
+                    };
+
+                    crcea_context ref = {
+                        .design = &design,
+                        .algorithm = CRCEA_REFERENCE,
+                    };
+
+                    crcea_int r = crcea(&ref, seq, seq + sizeof(seq), 0);
+
+                    FOREACH_LIST(int, algo,
+                                 CRCEA_FALLBACK,
+                                 CRCEA_BITWISE_BRANCHLESS,
+                                 CRCEA_BITCOMBINE8,
+                                 CRCEA_BY4_QUARTET,
+                                 CRCEA_BY1_OCTET,
+                                 CRCEA_BY8_OCTET,
+                                 CRCEA_BY32_OCTET,
+                                 CRCEA_BY8_OCTET_2WAY,
+                                 CRCEA_BY16_SEXDECTET,
+                                 CRCEA_CLMUL_FOLD,
+                                 CRCEA_VPCLMUL_FOLD,
+                                 CRCEA_SSE42_CRC32C,
+                                 CRCEA_AUTOMATIC) {
+                        crcea_context cc = {
+                            .design = &design,
+                            .algorithm = *algo,
+                            .table = NULL,
+                            .alloc = test_alloc,
+                            .free = test_free,
+                        };
+
+                        /* テーブルがなければ CRCEA_FALLBACK で計算されてしまうため、テーブルが用意されたことも確かめる */
+                        crcea_prepare_table(&cc);
+                        if (crcea_tablesize(&cc) != 0 && !cc.table) {
+                            bad = report_failure(&design, r, 0, "%s with crcea_int of 128 bits has no table", lookup_algorithm_name(*algo));
+                        }
+
+                        crcea_int s = crcea(&cc, seq, seq + 1000, 0);
+                        s = crcea_combine(&cc, s, crcea(&cc, seq + 1000, seq + sizeof(seq), 0), sizeof(seq) - 1000);
+                        crcea_release_table(&cc);
+
+                        cc.design = &crc82darc;
+                        crcea_prepare_table(&cc);
+                        if (crcea_tablesize(&cc) != 0 && !cc.table) {
+                            bad = report_failure(&crc82darc, check, 0, "%s with crcea_int of 128 bits has no table", lookup_algorithm_name(*algo));
+                        }
+
+                        crcea_int c = crcea(&cc, "123456789", "123456789" + 9, 0);
+                        crcea_release_table(&cc);
+
+                        if (r != s) {
+                            bad = report_failure(&design, r, s, "%s with crcea_int of 128 bits", lookup_algorithm_name(*algo));
+                        }
+                        if (c != check) {
+                            bad = report_failure(&crc82darc, check, c, "%s with crcea_int of 128 bits", lookup_algorithm_name(*algo));
+                        }
+                    }
+                }
+            }
+        }
+    }
+#endif
+
+    {
+        static const crcea_design crc32 = {
+            .bitsize = 32,
+            .polynomial = 0x04c11db7ul,
+            .reflectin = 1,
+            .reflectout = 1,
+            .appendzero = 1,
+            .xoroutput = ~0ul,
+        };
+
+        crcea_context cc = {
+            .design = &crc32,
+            .algorithm = CRCEA_BY8_OCTET,
+            .table = NULL,
+            .alloc = NULL,
+        };
+
+        /* 終了させた後もプールは再び起動される */
+        crcea_int r = crcea(&cc, seq, seq + sizeof(seq), 0);
+        for (int i = 0; i < 2; i ++) {
+            crcea_int s = crcea_finish(&cc, crcea_update_parallel(&cc, seq, seq + sizeof(seq), crcea_setup(&cc, 0), 4));
+            crcea_parallel_shutdown();
+            if (r != s) {
+                bad = report_failure(&crc32, r, s, "crcea_update_parallel after crcea_parallel_shutdown (%d)", i);
+            }
+        }
+
+        crcea_release_table(&cc);
+    }
+
     if (!bad) {
         puts("Test was passed all.");
     }
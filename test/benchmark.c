@@ -18,19 +18,19 @@
 //#define CRCEA_STRIP_SIZE 8
 #define CRCEA_ACADEMIC
 
-#define CRCEA_PREFIX      crc8
+#define CRCEA_PREFIX      crcea8
 #define CRCEA_TYPE        uint8_t
 #include "../include/crcea/core.h"
 
-#define CRCEA_PREFIX      crc16
+#define CRCEA_PREFIX      crcea16
 #define CRCEA_TYPE        uint16_t
 #include "../include/crcea/core.h"
 
-#define CRCEA_PREFIX      crc32
+#define CRCEA_PREFIX      crcea32
 #define CRCEA_TYPE        uint32_t
 #include "../include/crcea/core.h"
 
-#define CRCEA_PREFIX      crc64
+#define CRCEA_PREFIX      crcea64
 #define CRCEA_TYPE        uint64_t
 #include "../include/crcea/core.h"
 
@@ -122,17 +122,17 @@ main(int argc, char *argv[])
             .alloc = NULL,                                              \
         };                                                              \
                                                                         \
-        crc ## SIZE ## _build_table(&design, cc.algorithm, (TABLE));    \
+        crcea ## SIZE ## _build_table(&design, cc.algorithm, (TABLE));  \
         volatile uint32_t s = ~0; /* 最適化によって s が計算されないことを防止する */ \
         double t1 = ptime();                                            \
-        s = crc ## SIZE ## _setup(&design, 0);                          \
-        s = crc ## SIZE ## _update(&design, src, srcend - 1, s, (ALGO), (TABLE)); \
-        s = crc ## SIZE ## _finish(&design, s);                         \
+        s = crcea ## SIZE ## _setup(&design, 0);                        \
+        s = crcea ## SIZE ## _update(&design, src, srcend - 1, s, (ALGO), (TABLE)); \
+        s = crcea ## SIZE ## _finish(&design, s);                       \
         double t2 = ptime();                                            \
         double ti = t2 - t1;                                            \
         double rate = (size) / ti / 1024.0 / 1024.0;                    \
         printf("- { throughput: %8.2f MiB / sec., tablesize: %8d, algoright: %s }\n", \
-               rate, (int)crc ## SIZE ## _tablesize(cc.algorithm), #ALGO); \
+               rate, (int)crcea ## SIZE ## _tablesize(cc.algorithm), #ALGO); \
         fflush(stdout);                                                 \
     } while (0)                                                         \
 
@@ -179,11 +179,63 @@ main(int argc, char *argv[])
     MEASURE(CRCEA_BY8_OCTET,   table_s16);
     MEASURE(CRCEA_BY16_OCTET,  table_s16);
     MEASURE(CRCEA_BY32_OCTET,  table_s16);
+    MEASURE(CRCEA_BY8_OCTET_2WAY,  table_s16);
     MEASURE(CRCEA_BY2_SEXDECTET,   table_s16);
     MEASURE(CRCEA_BY4_SEXDECTET,   table_s16);
     MEASURE(CRCEA_BY8_SEXDECTET,   table_s16);
     MEASURE(CRCEA_BY16_SEXDECTET,   table_s16);
     MEASURE(CRCEA_BY32_SEXDECTET,   table_s16);
+    MEASURE(CRCEA_CLMUL_FOLD,   table_s16);
+    MEASURE(CRCEA_VPCLMUL_FOLD,   table_s16);
+
+    /*
+     * L1 キャッシュからテーブルを追い出した後の短いメッセージの処理時間
+     *
+     * 追い出しだけにかかる時間を差し引いて、1 メッセージあたりの時間とする。
+     */
+    static char evict[1 << 16];
+
+#define EVICT_L1()                                                      \
+    do {                                                                \
+        for (size_t i__ = 0; i__ < sizeof(evict); i__ += 64) {          \
+            evict[i__] ++;                                              \
+        }                                                               \
+    } while (0)                                                         \
+
+#define MEASURE_COLD00(ALGO, TABLE, SIZE, MSGSIZE)                      \
+    do {                                                                \
+        const int times = 200000;                                       \
+        crcea ## SIZE ## _build_table(&design, (ALGO), (TABLE));        \
+        volatile uint32_t s = 0; /* 最適化によって s が計算されないことを防止する */ \
+        double t1 = ptime();                                            \
+        for (int i = 0; i < times; i ++) {                              \
+            EVICT_L1();                                                 \
+            s = s ^ evict[i & 63];                                      \
+        }                                                               \
+        double t2 = ptime();                                            \
+        for (int i = 0; i < times; i ++) {                              \
+            const char *m = src + (size_t)i * (MSGSIZE) % (size - (MSGSIZE)); \
+            EVICT_L1();                                                 \
+            s = s ^ crcea ## SIZE ## _update(&design, m, m + (MSGSIZE), s, (ALGO), (TABLE)); \
+        }                                                               \
+        double t3 = ptime();                                            \
+        double ti = ((t3 - t2) - (t2 - t1)) / times;                    \
+        printf("- { latency: %8.1f nsec., message: %5d, tablesize: %8d, algoright: %s }\n", \
+               ti * 1e9, (MSGSIZE), (int)crcea ## SIZE ## _tablesize(ALGO), #ALGO); \
+        fflush(stdout);                                                 \
+    } while (0)                                                         \
+
+#define MEASURE_COLD0(ALGO, TABLE, SIZE, MSGSIZE) MEASURE_COLD00(ALGO, TABLE, SIZE, MSGSIZE)
+#define MEASURE_COLD(ALGO, TABLE, MSGSIZE) MEASURE_COLD0(ALGO, TABLE, SIZE, MSGSIZE)
+
+    MEASURE_COLD(CRCEA_BY4_QUARTET,     table_s16, 1500);
+    MEASURE_COLD(CRCEA_BY8_OCTET,       table_s16, 1500);
+    MEASURE_COLD(CRCEA_BY16_OCTET,      table_s16, 1500);
+    MEASURE_COLD(CRCEA_CLMUL_FOLD,      table_s16, 1500);
+    MEASURE_COLD(CRCEA_BY4_QUARTET,     table_s16, 4096);
+    MEASURE_COLD(CRCEA_BY8_OCTET,       table_s16, 4096);
+    MEASURE_COLD(CRCEA_BY16_OCTET,      table_s16, 4096);
+    MEASURE_COLD(CRCEA_CLMUL_FOLD,      table_s16, 4096);
 
 #define MEASURE_1(LABEL, TABLESIZE, CODE)                               \
     do {                                                                \